@@ -59,6 +59,8 @@ struct disk
 
 	long long read_cnt;	 /* Number of sectors read. */
 	long long write_cnt; /* Number of sectors written. */
+	long long read_cmd_cnt;	 /* Number of READ commands issued. */
+	long long write_cmd_cnt; /* Number of WRITE commands issued. */
 };
 
 /* ATA 채널(컨트롤러).
@@ -81,11 +83,15 @@ struct channel
 #define CHANNEL_CNT 2
 static struct channel channels[CHANNEL_CNT];
 
+/* 한 번의 READ/WRITE SECTOR 명령으로 전송할 수 있는 최대 섹터 수.
+	Sector Count 레지스터에 0을 쓰면 256 섹터를 의미합니다. */
+#define MAX_SECTORS_PER_CMD 256
+
 static void reset_channel(struct channel *);
 static bool check_device_type(struct disk *);
 static void identify_ata_device(struct disk *);
 
-static void select_sector(struct disk *, disk_sector_t);
+static void select_sector(struct disk *, disk_sector_t, size_t sec_cnt);
 static void issue_pio_command(struct channel *, uint8_t command);
 static void input_sector(struct channel *, void *);
 static void output_sector(struct channel *, const void *);
@@ -138,6 +144,7 @@ void disk_init(void)
 			d->capacity = 0;
 
 			d->read_cnt = d->write_cnt = 0;
+			d->read_cmd_cnt = d->write_cmd_cnt = 0;
 		}
 
 		/* Register interrupt handler. */
@@ -173,8 +180,9 @@ void disk_print_stats(void)
 		{
 			struct disk *d = disk_get(chan_no, dev_no);
 			if (d != NULL && d->is_ata)
-				printf("%s: %lld reads, %lld writes\n",
-					   d->name, d->read_cnt, d->write_cnt);
+				printf("%s: %lld reads, %lld writes (%lld read commands, %lld write commands)\n",
+					   d->name, d->read_cnt, d->write_cnt,
+					   d->read_cmd_cnt, d->write_cmd_cnt);
 		}
 	}
 }
@@ -214,45 +222,96 @@ disk_size(struct disk *d)
 /* 디스크 D에서 섹터 SEC_NO를 읽어 BUFFER에 저장합니다.
    BUFFER는 DISK_SECTOR_SIZE 바이트만큼의 공간이 있어야 합니다.
    내부적으로 디스크 접근을 동기화하므로, 별도의 디스크별 락은 필요하지 않습니다. */
-   void disk_read(struct disk *d, disk_sector_t sec_no, void *buffer)
+void disk_read(struct disk *d, disk_sector_t sec_no, void *buffer)
+{
+	disk_read_multiple(d, sec_no, &buffer, 1, 1);
+}
+
+/* BUFFER에 있는 데이터를 디스크 D의 섹터 SEC_NO에 기록합니다.
+   BUFFER는 DISK_SECTOR_SIZE 바이트를 포함해야 합니다.
+   디스크가 데이터를 받았음을 확인한 후 반환합니다.
+   내부적으로 디스크 접근을 동기화하므로, 별도의 디스크별 락은 필요하지 않습니다. */
+void disk_write(struct disk *d, disk_sector_t sec_no, const void *buffer)
+{
+	disk_write_multiple(d, sec_no, &buffer, 1, 1);
+}
+
+/* 디스크 D의 섹터 SEC_NO부터 연속된 BUF_CNT * BUF_SECTORS개의 섹터를 읽습니다.
+   BUFS[i]에는 BUF_SECTORS개의 섹터가 차례로 저장되므로, 각 버퍼는
+   BUF_SECTORS * DISK_SECTOR_SIZE 바이트의 공간이 있어야 합니다.
+   섹터마다 명령을 내리는 대신 최대 MAX_SECTORS_PER_CMD 섹터씩 한 명령으로 읽습니다. */
+void disk_read_multiple(struct disk *d, disk_sector_t sec_no,
+						void *const bufs[], size_t buf_cnt, size_t buf_sectors)
 {
 	struct channel *c;
+	size_t total = buf_cnt * buf_sectors;
+	size_t done = 0;
 
 	ASSERT(d != NULL);
-	ASSERT(buffer != NULL);
+	ASSERT(bufs != NULL);
+	ASSERT(buf_sectors > 0);
 
 	c = d->channel;
 	lock_acquire(&c->lock);
-	select_sector(d, sec_no);
-	issue_pio_command(c, CMD_READ_SECTOR_RETRY);
-	sema_down(&c->completion_wait);
-	if (!wait_while_busy(d))
-		PANIC("%s: disk read failed, sector=%" PRDSNu, d->name, sec_no);
-	input_sector(c, buffer);
-	d->read_cnt++;
+	while (done < total)
+	{
+		size_t cnt = total - done < MAX_SECTORS_PER_CMD ? total - done : MAX_SECTORS_PER_CMD;
+		size_t i;
+
+		select_sector(d, sec_no + done, cnt);
+		issue_pio_command(c, CMD_READ_SECTOR_RETRY);
+		/* PIO 읽기는 섹터마다 인터럽트가 발생한 뒤 데이터를 가져갑니다. */
+		for (i = 0; i < cnt; i++, done++)
+		{
+			uint8_t *buffer = bufs[done / buf_sectors];
+			sema_down(&c->completion_wait);
+			if (!wait_while_busy(d))
+				PANIC("%s: disk read failed, sector=%" PRDSNu, d->name,
+					  (disk_sector_t)(sec_no + done));
+			input_sector(c, buffer + (done % buf_sectors) * DISK_SECTOR_SIZE);
+		}
+		d->read_cnt += cnt;
+		d->read_cmd_cnt++;
+	}
 	lock_release(&c->lock);
 }
 
-/* BUFFER에 있는 데이터를 디스크 D의 섹터 SEC_NO에 기록합니다.
-   BUFFER는 DISK_SECTOR_SIZE 바이트를 포함해야 합니다.
-   디스크가 데이터를 받았음을 확인한 후 반환합니다.
-   내부적으로 디스크 접근을 동기화하므로, 별도의 디스크별 락은 필요하지 않습니다. */
-   void disk_write(struct disk *d, disk_sector_t sec_no, const void *buffer)
+/* BUFS의 데이터를 디스크 D의 섹터 SEC_NO부터 연속된 BUF_CNT * BUF_SECTORS개의
+   섹터에 기록합니다. BUFS[i]는 BUF_SECTORS * DISK_SECTOR_SIZE 바이트를 포함해야 합니다.
+   디스크가 모든 데이터를 받았음을 확인한 후 반환합니다. */
+void disk_write_multiple(struct disk *d, disk_sector_t sec_no,
+						 const void *const bufs[], size_t buf_cnt, size_t buf_sectors)
 {
 	struct channel *c;
+	size_t total = buf_cnt * buf_sectors;
+	size_t done = 0;
 
 	ASSERT(d != NULL);
-	ASSERT(buffer != NULL);
+	ASSERT(bufs != NULL);
+	ASSERT(buf_sectors > 0);
 
 	c = d->channel;
 	lock_acquire(&c->lock);
-	select_sector(d, sec_no);
-	issue_pio_command(c, CMD_WRITE_SECTOR_RETRY);
-	if (!wait_while_busy(d))
-		PANIC("%s: disk write failed, sector=%" PRDSNu, d->name, sec_no);
-	output_sector(c, buffer);
-	sema_down(&c->completion_wait);
-	d->write_cnt++;
+	while (done < total)
+	{
+		size_t cnt = total - done < MAX_SECTORS_PER_CMD ? total - done : MAX_SECTORS_PER_CMD;
+		size_t i;
+
+		select_sector(d, sec_no + done, cnt);
+		issue_pio_command(c, CMD_WRITE_SECTOR_RETRY);
+		/* PIO 쓰기는 DRQ를 기다려 섹터를 보낸 뒤 섹터마다 인터럽트를 받습니다. */
+		for (i = 0; i < cnt; i++, done++)
+		{
+			const uint8_t *buffer = bufs[done / buf_sectors];
+			if (!wait_while_busy(d))
+				PANIC("%s: disk write failed, sector=%" PRDSNu, d->name,
+					  (disk_sector_t)(sec_no + done));
+			output_sector(c, buffer + (done % buf_sectors) * DISK_SECTOR_SIZE);
+			sema_down(&c->completion_wait);
+		}
+		d->write_cnt += cnt;
+		d->write_cmd_cnt++;
+	}
 	lock_release(&c->lock);
 }
 
@@ -416,17 +475,18 @@ print_ata_string(char *string, size_t size)
 }
 
 /* 디바이스 D를 선택하고, 준비될 때까지 기다린 다음,
-   SEC_NO를 디스크의 섹터 선택 레지스터에 기록합니다. (LBA 모드를 사용함) */
+   SEC_NO와 섹터 수 SEC_CNT를 디스크의 섹터 선택 레지스터에 기록합니다. (LBA 모드를 사용함) */
 static void
-select_sector(struct disk *d, disk_sector_t sec_no)
+select_sector(struct disk *d, disk_sector_t sec_no, size_t sec_cnt)
 {
 	struct channel *c = d->channel;
 
-	ASSERT(sec_no < d->capacity);
-	ASSERT(sec_no < (1UL << 28));
+	ASSERT(sec_cnt > 0 && sec_cnt <= MAX_SECTORS_PER_CMD);
+	ASSERT(sec_no + sec_cnt <= d->capacity);
+	ASSERT(sec_no + sec_cnt <= (1UL << 28));
 
 	select_device_wait(d);
-	outb(reg_nsect(c), 1);
+	outb(reg_nsect(c), sec_cnt == MAX_SECTORS_PER_CMD ? 0 : sec_cnt);
 	outb(reg_lbal(c), sec_no);
 	outb(reg_lbam(c), sec_no >> 8);
 	outb(reg_lbah(c), (sec_no >> 16));
@@ -36,6 +36,18 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Process creation without fork. */
+	SYS_SPAWN,                  /* Start a new process from an executable. */
+
+	/* Virtual memory extensions. */
+	SYS_MADVISE,                /* Advise on the access pattern of a range. */
+	SYS_MINCORE,                /* Report which pages of a range are resident. */
+	SYS_SBRK,                   /* Grow or shrink the heap. */
+	SYS_MSYNC,                  /* Write back dirty pages of a file mapping. */
+	SYS_VMSTAT,                 /* Read page fault and eviction statistics. */
+	SYS_SET_RSS_LIMIT,          /* Cap the resident set of the process. */
+	SYS_GET_RSS,                /* Report the resident set size of the process. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <vmstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -12,6 +14,15 @@ typedef int pid_t;
 /* Map region identifier. */
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
+#define MAP_ANONYMOUS (-1)      /* Pass as mmap()'s fd for zero-filled memory. */
+
+/* madvise() advice values. */
+#define MADV_NORMAL 0           /* No special treatment. */
+#define MADV_RANDOM 1           /* Expect random access: no read-ahead. */
+#define MADV_SEQUENTIAL 2       /* Expect sequential access: read ahead more,
+                                   reclaim pages behind the scan early. */
+#define MADV_WILLNEED 3         /* Bring the range in now. */
+#define MADV_DONTNEED 4         /* Drop the range's frames and swap slots. */
 
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
@@ -37,10 +48,18 @@ unsigned tell (int fd);
 void close (int fd);
 
 int dup2(int oldfd, int newfd);
+pid_t spawn (const char *cmd_line, const int *fd_map, size_t fd_cnt);
 
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int madvise (void *addr, size_t length, int advice);
+int mincore (void *addr, size_t length, unsigned char *vec);
+void *sbrk (intptr_t increment);
+int msync (void *addr, size_t length);
+int get_vmstat (struct vmstat *st);
+int set_rss_limit (size_t pages);
+size_t get_rss (void);
 
 /* Project 4 only. */
 bool chdir (const char *dir);
@@ -0,0 +1,54 @@
+#ifndef __LIB_VMSTAT_H
+#define __LIB_VMSTAT_H
+
+#include <stdint.h>
+
+/* Virtual memory statistics shared by the kernel and the
+   get_vmstat() system call. */
+
+/* Page fault classes. */
+enum vmstat_fault {
+	VMSTAT_FAULT_STACK,         /* Stack growth. */
+	VMSTAT_FAULT_ELF,           /* Lazy load of an ELF segment or code page. */
+	VMSTAT_FAULT_MMAP,          /* Load of a file mapping page. */
+	VMSTAT_FAULT_ZERO,          /* Demand-zero anonymous or heap page. */
+	VMSTAT_FAULT_SWAP,          /* Swap-in from disk or compressed swap. */
+	VMSTAT_FAULT_COW,           /* Write to a shared or zero frame. */
+	VMSTAT_FAULT_MINOR,         /* Page was already resident or in transit. */
+	VMSTAT_FAULT_KERNEL,        /* Resolved on behalf of a system call. */
+	VMSTAT_FAULT_BOGUS,         /* Not resolvable; the process is killed. */
+	VMSTAT_FAULT_CNT
+};
+
+/* Page types counted separately on eviction. */
+enum vmstat_evict {
+	VMSTAT_EVICT_ANON,          /* Anonymous pages, written to swap. */
+	VMSTAT_EVICT_FILE,          /* File mapping pages, written to the file. */
+	VMSTAT_EVICT_TEXT,          /* Code pages, dropped without writing. */
+	VMSTAT_EVICT_CNT
+};
+
+/* Latency histogram in TSC cycles.  Bucket I counts events
+   that took [2^I, 2^(I+1)) cycles; the last bucket also counts
+   everything slower. */
+#define VMSTAT_BUCKETS 40
+struct vmstat_hist {
+	uint64_t cnt;               /* Number of events. */
+	uint64_t cycles;            /* Total cycles of all events. */
+	uint64_t max;               /* Slowest event. */
+	uint64_t buckets[VMSTAT_BUCKETS];
+};
+
+/* Eviction counters for one page type. */
+struct vmstat_evict_stat {
+	uint64_t pages;             /* Pages evicted. */
+	uint64_t written;           /* Pages written back while evicting. */
+	struct vmstat_hist writeback; /* Cycles per write, one per swap cluster. */
+};
+
+struct vmstat {
+	struct vmstat_hist faults[VMSTAT_FAULT_CNT];
+	struct vmstat_evict_stat evictions[VMSTAT_EVICT_CNT];
+};
+
+#endif /* lib/vmstat.h */
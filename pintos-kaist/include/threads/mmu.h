@@ -7,6 +7,10 @@
 
 typedef bool pte_for_each_func (uint64_t *pte, void *va, void *aux);
 
+extern bool pcid_enabled;
+
+void mmu_init (void);
+void mmu_print_stats (void);
 uint64_t *pml4e_walk (uint64_t *pml4, const uint64_t va, int create);
 uint64_t *pml4_create (void);
 bool pml4_for_each (uint64_t *, pte_for_each_func *, void *);
@@ -14,7 +18,12 @@ void pml4_destroy (uint64_t *pml4);
 void pml4_activate (uint64_t *pml4);
 void *pml4_get_page (uint64_t *pml4, const void *upage);
 bool pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw);
+bool pml4_set_huge_page (uint64_t *pml4, void *upage, void *kpage, bool rw);
+void pml4_split_huge_page (uint64_t *pml4, void *upage, uint64_t *pt);
 void pml4_clear_page (uint64_t *pml4, void *upage);
+void pml4_invalidate_page (uint64_t *pml4, const void *upage);
+void tlb_batch_begin (void);
+void tlb_batch_end (void);
 bool pml4_is_dirty (uint64_t *pml4, const void *upage);
 void pml4_set_dirty (uint64_t *pml4, const void *upage, bool dirty);
 bool pml4_is_accessed (uint64_t *pml4, const void *upage);
@@ -61,5 +61,10 @@
 #define PTE_U 0x4                           /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20                          /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40                          /* 1=dirty, 0=not dirty (PTEs only). */
+#define PTE_PS 0x80                         /* PDE에서 1=2MB 페이지를 직접 매핑. */
+
+/* PDE 하나가 PTE_PS로 직접 매핑하는 대형 페이지의 크기와 그 안의 4KB 페이지 수. */
+#define HUGE_PGSIZE (1UL << PDXSHIFT)
+#define HUGE_PGCNT (HUGE_PGSIZE / PGSIZE)
 
 #endif /* threads/pte.h */
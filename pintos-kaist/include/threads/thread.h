@@ -130,9 +130,6 @@ struct thread
 	/* project3 stack growth 유저스택 rsp */
 	void *user_rsp;
 
-	/* project3 mmap */
-	struct list mmap_list;
-
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4; /* Page map level 4 */
@@ -152,7 +149,6 @@ struct thread
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
-extern struct list frame_table;
 
 void thread_init(void);
 void thread_start(void);
@@ -205,4 +201,13 @@ struct fork_info
 	struct intr_frame parent_if;
 };
 
+/* process_spawn이 자식에게 넘기는 정보 */
+struct spawn_info
+{
+	struct thread *parent;
+	char *cmd_line;		/* 실행할 명령줄 (palloc 페이지) */
+	const int *fd_map;	/* 자식 fd i <- 부모 fd fd_map[i], NULL이면 모두 물려줌 */
+	size_t fd_cnt;		/* fd_map의 원소 수 */
+};
+
 #endif /* threads/thread.h */
\ No newline at end of file
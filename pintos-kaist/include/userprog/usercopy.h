@@ -0,0 +1,18 @@
+#ifndef USERPROG_USERCOPY_H
+#define USERPROG_USERCOPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 사용자 주소 범위를 페이지마다 미리 검사하지 않고 커널 메모리와 복사합니다.
+ * 복사 중에 난 페이지 폴트는 다른 폴트처럼 VM이 처리하고, 처리할 수 없으면
+ * 폴트 핸들러가 복사 함수의 복구 코드(copy-user.S의 예외 테이블)로 돌아가 복사가 실패합니다. */
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+/* 페이지 폴트 핸들러가 사용합니다. */
+uintptr_t usercopy_fixup (uintptr_t rip);
+
+#endif /* userprog/usercopy.h */
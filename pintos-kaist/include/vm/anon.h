@@ -3,14 +3,28 @@
 #include "vm/vm.h"
 struct page;
 enum vm_type;
+struct zswap_entry;
 
 struct anon_page
 {
-    /* 음수이면 스왑 아웃 상태가 아님 */
+    /* 스왑 슬롯 번호. 음수이면 슬롯이 없음.
+     * 프레임에 올라와 있어도 swap-in 뒤로 쓰이지 않았다면 슬롯의 사본을 가지고 있을 수 있음 */
     int swap_idx;
+    /* 압축 스왑 영역에 보관 중이면 그 항목, 아니면 NULL */
+    struct zswap_entry *zswap;
 };
 
+/* 한 번의 디스크 명령으로 내보내거나 미리 읽는 최대 페이지 수 */
+#define SWAP_CLUSTER 8
+
 void vm_anon_init(void);
 bool anon_initializer(struct page *page, enum vm_type type, void *kva);
+bool anon_swap_out_cluster(struct page *pages[], size_t cnt);
+void anon_swap_in_cluster(struct page *pages[], size_t cnt);
+void anon_swap_release(struct page *page);
+bool anon_swap_share(struct page *dst, struct page *src);
+bool anon_is_swapped(struct page *page);
+bool anon_writeback(struct page *page, const void *buf);
+void anon_print_stats(void);
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef VM_EVICT_H
+#define VM_EVICT_H
+#include <stdbool.h>
+#include <stddef.h>
+
+struct frame;
+struct page;
+
+/* 교체 정책: clock(기본값, WSClock), fifo(second-chance FIFO),
+ * lru(multi-bit aging), 2q(스캔에 강한 2Q, "arc"도 같은 정책).
+ * 커널 커맨드라인 옵션 "-evict=POLICY"로 고릅니다. */
+bool evict_set_policy(const char *name);
+const char *evict_policy_name(void);
+
+/* 프레임 테이블(vm.c)이 부르는 정책 훅. 모두 frame_lock을 보유한 상태에서 호출합니다. */
+void evict_init(struct frame *table, size_t cnt);
+void evict_insert(struct frame *frame);
+void evict_remove(struct frame *frame);
+void evict_mapped(struct frame *frame, struct page *page);
+struct frame *evict_select(void);
+
+/* 정책이 쓰는 프레임 테이블 도우미 (vm.c) */
+bool frame_evictable(struct frame *frame);
+bool frame_test_and_clear_accessed(struct frame *frame);
+bool frame_is_clean(struct frame *frame);
+void frame_queue_clean(struct frame *frame);
+
+#endif
@@ -4,13 +4,15 @@
 #include "vm/vm.h"
 
 struct page;
+struct segment;
 enum vm_type;
 
 struct file_page
 {
 	/* dirty bit가 명시적으로 필요한가??
 	어차피 PTE의 dirty bit가 있는데  */
-	int mapping_count;
+	/* 파일 핸들을 소유한 구간 디스크립터 (페이지가 살아 있는 동안 참조를 잡고 있음) */
+	struct segment *seg;
 
 	// file_backup 정보를 필드로 두어도 될듯함
 	struct file *file;
@@ -21,6 +23,8 @@ struct file_page
 
 void vm_file_init(void);
 bool file_backed_initializer(struct page *page, enum vm_type type, void *kva);
+bool text_initializer(struct page *page, enum vm_type type, void *kva);
+bool file_backed_write_back(struct page *page);
 void *do_mmap(void *addr, size_t length, int writable,
 			  struct file *file, off_t offset);
 void do_munmap(void *va);
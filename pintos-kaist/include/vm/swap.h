@@ -0,0 +1,20 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* swap_alloc()이 실패했을 때 반환하는 값 */
+#define SWAP_ERROR ((size_t) -1)
+
+/* 초기화 직후 할당기를 스스로 점검할지 여부 ("-swap-check") */
+extern bool swap_check;
+
+void swap_init(size_t slot_cnt);
+size_t swap_alloc(size_t cnt);
+void swap_free(size_t slot, size_t cnt);
+void swap_share(size_t slot);
+bool swap_in_use(size_t slot);
+bool swap_full(void);
+void swap_print_stats(void);
+
+#endif
@@ -2,6 +2,7 @@
 #define VM_VM_H
 #include <stdbool.h>
 #include "threads/palloc.h"
+#include "threads/vaddr.h"
 #include "hash.h"
 
 enum vm_type
@@ -16,6 +17,8 @@ enum vm_type
 	VM_PAGE_CACHE = 3,
 	/* mmap 파일 페이지 */
 	VM_MMAP = 4,
+	/* 읽기 전용 실행 코드 페이지 (프로세스 간에 프레임을 공유) */
+	VM_TEXT = 5,
 
 	/* 상태를 저장하기 위한 비트 플래그 */
 
@@ -31,6 +34,7 @@ enum vm_type
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/vma.h"
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
 #endif
@@ -38,8 +42,21 @@ enum vm_type
 struct page_operations;
 struct thread;
 
+/* madvise로 알려 주는 접근 패턴. 사용자 라이브러리의 MADV_* 값과 순서가 같습니다.
+ * 앞의 세 값은 페이지에 남아 폴트 처리를 바꾸고, 나머지는 호출 시점에 한 번 적용됩니다. */
+enum vm_advice
+{
+	VM_ADV_NORMAL,
+	VM_ADV_RANDOM,	   /* fault-around와 스왑 readahead를 하지 않음 */
+	VM_ADV_SEQUENTIAL, /* 최대 창으로 미리 읽고, 지나간 페이지를 먼저 내보냄 */
+	VM_ADV_WILLNEED,   /* 지금 올려 둠 */
+	VM_ADV_DONTNEED,   /* 프레임과 스왑 슬롯을 바로 버림 */
+};
+
 #define VM_TYPE(type) ((type) & 7)
 #define STACK_GROW_RANGE 4192
+/* 사용자 스택이 자랄 수 있는 최대 크기 */
+#define STACK_MAX_SIZE (1 << 20)
 
 /* "page"의 표현입니다.
  * 이것은 일종의 "부모 클래스"로, 네 개의 "자식 클래스"를 가집니다:
@@ -55,6 +72,20 @@ struct page
 	bool writable;
 	// 매핑된 프레임이 스왑되어있는가??
 	bool is_swap;
+	/* madvise로 받은 접근 패턴 (VM_ADV_NORMAL, VM_ADV_RANDOM, VM_ADV_SEQUENTIAL) */
+	enum vm_advice advice;
+	/* 페이지가 속한 SPT. 상주 페이지 수를 셀 때 씁니다 */
+	struct supplemental_page_table *spt;
+
+	/* 역매핑(rmap) 정보: frame에 매핑되어 있는 동안만 유효합니다.
+	 * PTE 포인터를 캐시해 두어 aging, dirty 검사, 매핑 해제를
+	 * pml4e_walk 없이 O(1)에 처리합니다. */
+	uint64_t *pml4;			   /* 매핑이 설치된 페이지 테이블 */
+	uint64_t *pte;			   /* va에 대한 PTE */
+	struct list_elem map_elem; /* frame->mappings 소속 elem */
+
+	/* SPT 해시 테이블 소속 elem. 키는 va 입니다. */
+	struct hash_elem spt_elem;
 
 	/* 타입별 데이터는 union에 바인딩됩니다.
 	 * 각 함수는 현재 union을 자동으로 감지합니다. */
@@ -69,15 +100,35 @@ struct page
 	};
 };
 
-/* The representation of "frame" */
+/* The representation of "frame"
+ * 프레임 테이블은 vm_init()에서 유저 풀 페이지 수만큼 한 번에 할당되는 배열이며,
+ * 유저 풀 페이지 번호로 인덱싱됩니다. (kva -> frame 조회가 O(1)) */
 struct frame
 {
-	void *kva;
-	/* extra-cow */
+	void *kva; /* 고정: 이 엔트리가 나타내는 유저 풀 페이지 */
+	/* extra-cow : 이 프레임을 매핑하고 있는 페이지 수 */
 	int ref_cnt;
-	struct page *page;
-	// frame_table 소속 elem
-	struct list_elem elem;
+	/* 역매핑 리스트: 이 프레임을 매핑한 모든 페이지 (COW 공유자 포함) */
+	struct list mappings;
+	/* 내용을 채우는 중이거나 교체 중인 프레임은 victim으로 고르지 않습니다 */
+	bool pinned;
+	/* 페이지에 할당되어 사용 중인가? */
+	bool in_use;
+	/* 실행 코드 프레임 캐시의 키 (inode, 파일 오프셋). 캐시에 없으면 text_inode가 NULL */
+	struct inode *text_inode;
+	off_t text_ofs;
+	struct hash_elem text_elem;
+	/* 2MB 대형 페이지(PDE 하나)로 함께 매핑된 512개 프레임 중 하나인가?
+	 * 그동안 각 프레임에는 매핑이 정확히 하나 있고, 그 페이지의 pte는 PDE를 가리킵니다. */
+	bool huge;
+	/* 대형 페이지 묶음의 첫 프레임: 쪼갤 때 쓸 빈 페이지 테이블 (미리 할당해 둠) */
+	uint64_t *huge_pt;
+	/* 회수 스레드가 dirty한 내용을 미리 기록하도록 cleaning 큐에 들어 있는가? */
+	bool clean_queued;
+	/* 교체 정책(vm/evict.c)의 상태: fifo와 2q가 프레임을 담는 큐, lru의 aging 카운터 */
+	struct list_elem policy_elem;
+	uint8_t policy_queue;
+	uint8_t age;
 };
 
 /* 페이지 작업을 위한 함수 테이블입니다.
@@ -104,38 +155,49 @@ struct page_operations
 struct supplemental_page_table
 {
 	struct hash SPT_hash_list;
-};
-
-struct SPT_entry
-{
-	/* 이 엔트리의 키 값이 될 가상 주소 */
-	void *va;
-	/* 페이지 */
-	struct page *page;
-	/* 해시 테이블 요소*/
-	struct hash_elem elem;
+	/* 주소 공간의 영역(ELF 세그먼트, 스택, mmap, 힙) */
+	struct vma_set vmas;
+	/* 힙: [heap_start, brk). 첫 sbrk 때 ELF 세그먼트 바로 뒤로 정해지며 그 전에는 NULL */
+	uint8_t *heap_start;
+	uint8_t *brk;
+	/* 상주 페이지 수(RSS): 프레임에 매핑된 페이지 수. zero 프레임 매핑은 세지 않습니다.
+	 * rss_limit이 0이 아니면 이를 넘지 않도록 폴트 때 자기 프레임부터 내보냅니다.
+	 * 모두 frame_lock이 보호합니다. */
+	size_t rss;
+	size_t rss_limit;
+	struct list_elem rss_elem; /* 상주 페이지가 있는 주소 공간 리스트의 원소 */
 };
 
 /* 
- * 페이지가 lazy loading 될 때 사용될 보조 정보 구조체
- * 이 구조체는 실제 페이지 fault가 발생했을 때 필요한 파일 위치 및 읽기 정보를 포함함
+ * 지연 로딩할 파일 구간(ELF 세그먼트 하나 또는 mmap 하나)의 디스크립터
+ * 구간의 모든 페이지가 같은 디스크립터를 lazy_load_segment의 aux로 공유하며,
+ * 페이지별 파일 오프셋과 읽을 바이트 수는 구간 안에서의 위치(가상 주소)로 계산함
+ * 만든 뒤에는 바뀌지 않으므로 fork한 자식도 복사 없이 참조만 늘려 공유함
  */
-struct lazy_load_info {
-    struct file *file;       // 읽을 파일 포인터 (reopen된 파일 핸들)
-    off_t offset;            // 해당 페이지의 파일 내 시작 위치 (offset)
-    size_t readbyte;         // 파일에서 읽어야 할 바이트 수
-    size_t zerobyte;         // 나머지를 0으로 채워야 할 바이트 수 (ex. .bss 영역 같은 경우)
+struct segment {
+    struct file *file;       // 구간이 소유하는 파일 핸들 (구간마다 한 번만 reopen)
+    uint8_t *upage;          // 구간 첫 페이지의 가상 주소
+    off_t offset;            // 구간 첫 페이지의 파일 내 시작 위치 (offset)
+    size_t read_bytes;       // 파일에서 읽어야 할 총 바이트 수 (이후는 0으로 채움, ex. .bss)
+    int ref_cnt;             // 이 디스크립터를 참조하는 페이지 수 (+ 만드는 중인 쪽)
 };
 
-/*
- * mmap을 통해 매핑된 각 페이지에 대한 식별자 역할을 하는 구조체
- * - info는 해당 페이지의 lazy loading 정보를 포함
- * - mapping_count는 mmap 전체 중 몇 번째 페이지인지 나타냄
- */
-struct mmap_info {
-    struct lazy_load_info *info;  // 지연 로딩에 필요한 보조 정보
-    int mapping_count;            // mmap된 페이지 중 순서 (ex. 0번째 페이지, 1번째 ...)
-};
+/* 구간 SEG에서 가상 주소 VA에 있는 페이지의 파일 오프셋 */
+static inline off_t
+segment_page_offset(const struct segment *seg, const void *va)
+{
+    return seg->offset + (off_t)((const uint8_t *)va - seg->upage);
+}
+
+/* 구간 SEG에서 가상 주소 VA에 있는 페이지가 파일에서 읽을 바이트 수 (나머지는 0) */
+static inline size_t
+segment_page_read_bytes(const struct segment *seg, const void *va)
+{
+    size_t start = (const uint8_t *)va - seg->upage;
+    if (start >= seg->read_bytes)
+        return 0;
+    return seg->read_bytes - start < PGSIZE ? seg->read_bytes - start : PGSIZE;
+}
 
 #include "threads/thread.h"
 void supplemental_page_table_init(struct supplemental_page_table *spt);
@@ -147,7 +209,20 @@ struct page *spt_find_page(struct supplemental_page_table *spt,
 bool spt_insert_page(struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page);
 
+/* 백그라운드 회수 스레드의 빈 프레임 워터마크 (0이면 vm_init이 정함) */
+extern size_t reclaim_low_wm;
+extern size_t reclaim_high_wm;
+/* 파일 지연 로딩 폴트 때 함께 읽어 매핑할 최대 페이지 수 */
+extern size_t fault_around_pages;
+/* 정렬된 2MB 익명 영역을 대형 페이지로 매핑할지 여부 */
+extern bool huge_pages;
+/* 백그라운드 flusher가 dirty한 mmap 페이지를 기록하는 주기 (틱, 0이면 끔) */
+extern size_t flush_interval;
+/* 새 프로세스의 상주 페이지 상한 (페이지, 0이면 제한 없음) */
+extern size_t rss_limit_default;
+
 void vm_init(void);
+void vm_print_stats(void);
 bool vm_try_handle_fault(struct intr_frame *f, void *addr, bool user,
 						 bool write, bool not_present);
 
@@ -157,16 +232,21 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage,
 									bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page(struct page *page);
 bool vm_claim_page(void *va);
+bool vm_madvise(void *addr, size_t length, enum vm_advice advice);
+bool vm_mincore(void *addr, size_t length, unsigned char *vec);
+bool vm_msync(void *addr, size_t length);
+void *vm_sbrk(intptr_t increment);
+void vm_set_rss_limit(size_t pages);
+size_t vm_get_rss(void);
 enum vm_type page_get_type(struct page *page);
 
-void frame_table_insert(struct list_elem *elem);
-struct frame *frame_table_remove(void);
+struct frame *frame_from_kva(void *kva);
 
-struct mmap_info *make_mmap_info(struct lazy_load_info *info,
-								 int mapping_count);
-struct lazy_load_info *make_info(
-	struct file *file, off_t offset, size_t read_byte);
+struct segment *segment_create(struct file *file, void *upage, off_t offset, size_t read_bytes);
+struct segment *segment_get(struct segment *seg);
+void segment_put(struct segment *seg);
 
-bool vm_copy_claim_page(void *va, struct page *parent, struct supplemental_page_table *parent_spt);
+bool page_is_dirty(struct page *page);
+void page_set_dirty(struct page *page, bool dirty);
 
 #endif /* VM_VM_H */
@@ -0,0 +1,50 @@
+#ifndef VM_VMA_H
+#define VM_VMA_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* 영역의 용도 */
+enum vma_kind
+{
+	VMA_SEGMENT, /* ELF 세그먼트 (코드, 데이터, bss) */
+	VMA_STACK,	 /* 사용자 스택 (스택이 자랄 수 있는 범위 전체) */
+	VMA_MMAP,	 /* mmap()으로 매핑한 파일 */
+	VMA_ANON,	 /* mmap(MAP_ANONYMOUS)으로 매핑한 익명 메모리 */
+	VMA_HEAP,	 /* sbrk()로 늘리고 줄이는 힙 */
+};
+
+/* 페이지를 미리 만들지 않고, 처음 접근할 때 0으로 채워진 익명 페이지를 만드는 영역인가? */
+#define vma_is_demand_zero(vma) ((vma)->kind == VMA_ANON || (vma)->kind == VMA_HEAP)
+
+/* 가상 메모리 영역(VMA): 주소 공간에서 같은 방식으로 관리되는
+ * 페이지 정렬된 연속 범위 [start, end) 입니다. */
+struct vma
+{
+	void *start;
+	void *end;
+	enum vma_kind kind;
+	bool writable;
+};
+
+/* 한 주소 공간의 영역 집합.
+ * 시작 주소 순으로 정렬된 포인터 배열이며 영역끼리는 겹치지 않으므로
+ * 주소로 영역을 찾거나 겹침을 검사하는 데 O(log 영역 수)가 듭니다. */
+struct vma_set
+{
+	struct vma **vmas;
+	size_t cnt;
+	size_t cap;
+};
+
+void vma_set_init(struct vma_set *set);
+void vma_set_destroy(struct vma_set *set);
+bool vma_set_copy(struct vma_set *dst, const struct vma_set *src);
+struct vma *vma_find(const struct vma_set *set, const void *addr);
+bool vma_overlaps(const struct vma_set *set, const void *start, const void *end);
+struct vma *vma_insert(struct vma_set *set, void *start, void *end,
+					   enum vma_kind kind, bool writable);
+void vma_remove(struct vma_set *set, struct vma *vma);
+bool vma_resize(struct vma_set *set, struct vma *vma, void *end);
+void *vma_kind_end(const struct vma_set *set, enum vma_kind kind);
+
+#endif
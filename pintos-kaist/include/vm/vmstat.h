@@ -0,0 +1,13 @@
+#ifndef VM_VMSTAT_H
+#define VM_VMSTAT_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <vmstat.h>
+
+void vmstat_fault(enum vmstat_fault class, uint64_t cycles);
+void vmstat_evict(enum vmstat_evict type);
+void vmstat_writeback(enum vmstat_evict type, size_t pages, uint64_t cycles);
+void vmstat_get(struct vmstat *st);
+void vmstat_print(void);
+
+#endif
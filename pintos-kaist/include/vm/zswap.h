@@ -0,0 +1,19 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+
+struct page;
+
+/* 압축 스왑 영역으로 쓸 커널 풀 페이지 수. 0이면 사용하지 않습니다.
+ * 커널 커맨드라인 옵션 "-zswap=PAGES"로 설정합니다. */
+extern size_t zswap_pages;
+
+void zswap_init(void);
+bool zswap_store(struct page *page, const void *kva);
+bool zswap_load(struct page *page, void *kva);
+bool zswap_dup(struct page *dst, struct page *src);
+void zswap_invalidate(struct page *page);
+void zswap_print_stats(long long disk_loads);
+
+#endif
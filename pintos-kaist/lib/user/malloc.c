@@ -0,0 +1,319 @@
+/* malloc.c: 사용자 프로그램용 힙 할당기.
+ *
+ * 커널의 threads/malloc.c와 같은 구조입니다.
+ * - 요청 크기를 2의 거듭제곱(16 ~ 1024 바이트)으로 올려 크기 등급(descriptor)에 맡깁니다.
+ *   각 등급은 한 페이지짜리 아레나를 여러 블록으로 나눠 쓰고, 아레나마다 빈 블록 리스트를 둡니다.
+ *   빈 블록이 있는 아레나만 등급의 아레나 리스트에 걸려 있으므로 할당은 리스트 맨 앞에서 바로 끝나고,
+ *   아레나의 블록이 모두 반환되면 그 리스트에서 빼서 페이지를 돌려줍니다.
+ * - 그보다 큰 요청은 연속된 페이지를 통째로 주고, 아레나 머리에 페이지 수를 적어 둡니다.
+ *
+ * 페이지는 sbrk()로 늘린 힙에서 얻습니다. 커널은 늘린 범위에 페이지를 미리 만들지 않고
+ * 처음 접근할 때 0으로 채운 페이지를 붙이므로, 할당만 하고 쓰지 않은 메모리는 프레임을 쓰지 않습니다.
+ * 반환된 페이지는 주소 순으로 정렬된 빈 구간 리스트에 이웃과 합쳐 두었다가 다시 쓰고,
+ * 빈 구간이 힙 끝에 닿으면 sbrk()로 힙을 줄이며, 그렇지 않으면 madvise(MADV_DONTNEED)로
+ * 프레임만 커널에 돌려줍니다.
+ *
+ * 사용자 프로세스는 스레드가 하나뿐이므로 락을 두지 않습니다. */
+
+#include <malloc.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+
+#define PAGE_SIZE 4096
+
+/* 크기 등급 */
+struct desc {
+	size_t block_size;          /* 블록 크기 (바이트) */
+	size_t blocks_per_arena;    /* 아레나 하나에 들어가는 블록 수 */
+	struct arena *arenas;       /* 빈 블록이 남은 아레나들의 리스트 */
+};
+
+/* 아레나 손상을 알아채기 위한 값 */
+#define ARENA_MAGIC 0x9a548eed
+
+/* 아레나: 페이지 맨 앞에 놓이는 머리 */
+struct arena {
+	unsigned magic;             /* 항상 ARENA_MAGIC */
+	struct desc *desc;          /* 소속 등급, 큰 블록이면 NULL */
+	size_t free_cnt;            /* 빈 블록 수, 큰 블록이면 페이지 수 */
+	struct block *free_list;    /* 이 아레나의 빈 블록들 */
+	struct arena *prev, *next;  /* 등급의 아레나 리스트 원소 */
+};
+
+/* 빈 블록 */
+struct block {
+	struct block *next;
+};
+
+/* 반환되어 다시 쓸 수 있는 연속된 페이지 구간. 구간의 첫 페이지에 놓입니다. */
+struct run {
+	size_t page_cnt;
+	struct run *next;           /* 주소 순으로 다음 구간 */
+};
+
+static struct desc descs[7];    /* 16, 32, ..., 1024 바이트 */
+static size_t desc_cnt;
+static struct run *free_runs;   /* 주소 순으로 정렬된 빈 구간 리스트 */
+
+#define pg_ofs(va) ((uintptr_t) (va) & (PAGE_SIZE - 1))
+#define pg_round_down(va) ((void *) ((uintptr_t) (va) & ~(uintptr_t) (PAGE_SIZE - 1)))
+#define run_end(r) ((uint8_t *) (r) + (r)->page_cnt * PAGE_SIZE)
+
+/* 크기 등급을 처음 쓸 때 한 번 초기화합니다. */
+static void
+malloc_init (void) {
+	for (size_t block_size = 16; block_size < PAGE_SIZE / 2; block_size *= 2) {
+		struct desc *d = &descs[desc_cnt++];
+		ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
+		d->block_size = block_size;
+		d->blocks_per_arena = (PAGE_SIZE - sizeof (struct arena)) / block_size;
+		d->arenas = NULL;
+	}
+}
+
+/* 연속된 PAGE_CNT개 페이지를 얻습니다. 빈 구간에서 먼저 찾고(first-fit),
+ * 없으면 힙을 늘립니다. 실패하면 NULL. */
+static void *
+pages_get (size_t page_cnt) {
+	struct run **rp;
+
+	for (rp = &free_runs; *rp != NULL; rp = &(*rp)->next) {
+		struct run *r = *rp;
+		if (r->page_cnt < page_cnt)
+			continue;
+		if (r->page_cnt == page_cnt)
+			*rp = r->next;
+		else {
+			struct run *rest = (struct run *) ((uint8_t *) r + page_cnt * PAGE_SIZE);
+			rest->page_cnt = r->page_cnt - page_cnt;
+			rest->next = r->next;
+			*rp = rest;
+		}
+		return r;
+	}
+
+	/* 힙 끝이 페이지 경계에 있도록 유지합니다 */
+	uint8_t *brk = sbrk (0);
+	if (brk == (void *) -1)
+		return NULL;
+	size_t pad = (PAGE_SIZE - pg_ofs (brk)) % PAGE_SIZE;
+	if (page_cnt > (SIZE_MAX - pad) / PAGE_SIZE)
+		return NULL;
+	if (sbrk (pad + page_cnt * PAGE_SIZE) == (void *) -1)
+		return NULL;
+	return brk + pad;
+}
+
+/* PAGES부터 PAGE_CNT개 페이지를 돌려줍니다.
+ * 이웃한 빈 구간과 합치고, 합친 구간이 힙 끝에 닿으면 힙을 줄입니다. */
+static void
+pages_put (void *pages, size_t page_cnt) {
+	struct run *r = pages;
+	struct run **rp = &free_runs;   /* R을 가리키게 될 링크 */
+	struct run **prevp = NULL;      /* R 바로 앞 구간을 가리키는 링크 */
+
+	while (*rp != NULL && *rp < r) {
+		prevp = rp;
+		rp = &(*rp)->next;
+	}
+
+	/* 프레임을 돌려줄 범위: 새로 구간 머리가 되는 페이지는 남겨 둡니다 */
+	uint8_t *drop = (uint8_t *) pages + PAGE_SIZE;
+	size_t drop_cnt = page_cnt - 1;
+
+	r->page_cnt = page_cnt;
+	r->next = *rp;
+	if (r->next != NULL && run_end (r) == (uint8_t *) r->next) {
+		r->page_cnt += r->next->page_cnt;
+		r->next = r->next->next;
+	}
+	if (prevp != NULL && run_end (*prevp) == (uint8_t *) r) {
+		(*prevp)->page_cnt += r->page_cnt;
+		(*prevp)->next = r->next;
+		rp = prevp;
+		drop = pages;
+		drop_cnt = page_cnt;
+	} else
+		*rp = r;
+
+	/* 힙 끝에 닿은 구간은 통째로 커널에 돌려줍니다 */
+	r = *rp;
+	if (run_end (r) == sbrk (0)) {
+		*rp = r->next;
+		sbrk (-(intptr_t) (r->page_cnt * PAGE_SIZE));
+		return;
+	}
+
+	if (drop_cnt > 0)
+		madvise (drop, drop_cnt * PAGE_SIZE, MADV_DONTNEED);
+}
+
+/* 블록 B가 속한 아레나를 반환합니다. */
+static struct arena *
+block_to_arena (struct block *b) {
+	struct arena *a = pg_round_down (b);
+
+	ASSERT (a != NULL);
+	ASSERT (a->magic == ARENA_MAGIC);
+	ASSERT (a->desc == NULL
+			|| (pg_ofs (b) - sizeof *a) % a->desc->block_size == 0);
+	ASSERT (a->desc != NULL || pg_ofs (b) == sizeof *a);
+	return a;
+}
+
+/* 아레나 A를 등급의 아레나 리스트 맨 앞에 겁니다. */
+static void
+arena_link (struct desc *d, struct arena *a) {
+	a->prev = NULL;
+	a->next = d->arenas;
+	if (d->arenas != NULL)
+		d->arenas->prev = a;
+	d->arenas = a;
+}
+
+/* 아레나 A를 등급의 아레나 리스트에서 뺍니다. */
+static void
+arena_unlink (struct desc *d, struct arena *a) {
+	if (a->prev != NULL)
+		a->prev->next = a->next;
+	else
+		d->arenas = a->next;
+	if (a->next != NULL)
+		a->next->prev = a->prev;
+}
+
+/* SIZE 바이트 이상의 블록을 할당해 반환합니다. 메모리가 없으면 NULL. */
+void *
+malloc (size_t size) {
+	struct desc *d;
+	struct arena *a;
+	struct block *b;
+
+	if (size == 0)
+		return NULL;
+	if (desc_cnt == 0)
+		malloc_init ();
+
+	for (d = descs; d < descs + desc_cnt; d++)
+		if (d->block_size >= size)
+			break;
+	if (d == descs + desc_cnt) {
+		/* 큰 블록: 페이지를 통째로 줍니다 */
+		if (size > SIZE_MAX - sizeof *a - PAGE_SIZE)
+			return NULL;
+		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PAGE_SIZE);
+		a = pages_get (page_cnt);
+		if (a == NULL)
+			return NULL;
+		a->magic = ARENA_MAGIC;
+		a->desc = NULL;
+		a->free_cnt = page_cnt;
+		return a + 1;
+	}
+
+	if (d->arenas == NULL) {
+		a = pages_get (1);
+		if (a == NULL)
+			return NULL;
+		a->magic = ARENA_MAGIC;
+		a->desc = d;
+		a->free_cnt = d->blocks_per_arena;
+		a->free_list = NULL;
+		for (size_t i = d->blocks_per_arena; i-- > 0; ) {
+			b = (struct block *) ((uint8_t *) (a + 1) + i * d->block_size);
+			b->next = a->free_list;
+			a->free_list = b;
+		}
+		arena_link (d, a);
+	}
+
+	a = d->arenas;
+	b = a->free_list;
+	a->free_list = b->next;
+	if (--a->free_cnt == 0)
+		arena_unlink (d, a);
+	return b;
+}
+
+/* A * B 바이트를 0으로 채워 할당합니다. */
+void *
+calloc (size_t a, size_t b) {
+	void *p;
+	size_t size;
+
+	size = a * b;
+	if (size < a || size < b)
+		return NULL;
+
+	p = malloc (size);
+	if (p != NULL)
+		memset (p, 0, size);
+	return p;
+}
+
+/* 블록 B에 담을 수 있는 바이트 수 */
+static size_t
+block_size (void *block) {
+	struct arena *a = block_to_arena (block);
+
+	return a->desc != NULL ? a->desc->block_size
+	                       : a->free_cnt * PAGE_SIZE - sizeof *a;
+}
+
+/* OLD_BLOCK의 크기를 NEW_SIZE로 바꿉니다. 블록이 옮겨질 수 있습니다. */
+void *
+realloc (void *old_block, size_t new_size) {
+	if (new_size == 0) {
+		free (old_block);
+		return NULL;
+	}
+	if (old_block == NULL)
+		return malloc (new_size);
+
+	size_t old_size = block_size (old_block);
+	if (new_size <= old_size)
+		return old_block;
+
+	void *new_block = malloc (new_size);
+	if (new_block != NULL) {
+		memcpy (new_block, old_block, old_size);
+		free (old_block);
+	}
+	return new_block;
+}
+
+/* P가 가리키는 블록을 해제합니다. P는 NULL이거나 malloc이 돌려준 블록이어야 합니다. */
+void
+free (void *p) {
+	if (p == NULL)
+		return;
+
+	struct block *b = p;
+	struct arena *a = block_to_arena (b);
+	struct desc *d = a->desc;
+
+	if (d == NULL) {
+		pages_put (a, a->free_cnt);
+		return;
+	}
+
+#ifndef NDEBUG
+	/* use-after-free 버그가 잘 드러나도록 채워 둡니다 */
+	memset (b, 0xcc, d->block_size);
+#endif
+
+	b->next = a->free_list;
+	a->free_list = b;
+	if (a->free_cnt++ == 0)
+		arena_link (d, a);
+
+	/* 아레나가 통째로 비었으면 페이지를 돌려줍니다 */
+	if (a->free_cnt >= d->blocks_per_arena) {
+		ASSERT (a->free_cnt == d->blocks_per_arena);
+		arena_unlink (d, a);
+		pages_put (a, 1);
+	}
+}
@@ -234,6 +234,17 @@ int dup2(int oldfd, int newfd)
 	return syscall2(SYS_DUP2, oldfd, newfd);
 }
 
+/* spawn:
+ * cmd_line의 프로그램을 새 자식 프로세스로 바로 시작한다 (fork + exec를 한 번에).
+ * 부모의 주소 공간을 복제하지 않으므로 부모가 커도 생성 비용이 늘지 않는다.
+ * fd_map이 NULL이면 부모의 열린 파일을 모두 물려주고, 아니면 자식의 fd i에
+ * 부모의 fd fd_map[i]를 fd_cnt개까지 물려준다 (음수이면 닫힌 fd).
+ * 자식의 pid를, 실패하면 -1을 반환한다. */
+pid_t spawn(const char *cmd_line, const int *fd_map, size_t fd_cnt)
+{
+	return (pid_t)syscall3(SYS_SPAWN, cmd_line, fd_map, fd_cnt);
+}
+
 // 아래부터는 일부는 프로젝트3에서, 나머지는 프로젝트 4에서 구현하게 됨.
 void *
 mmap(void *addr, size_t length, int writable, int fd, off_t offset)
@@ -246,6 +257,65 @@ void munmap(void *addr)
 	syscall1(SYS_MUNMAP, addr);
 }
 
+/* madvise:
+ * [addr, addr + length) 범위를 어떻게 쓸지 커널에 알린다 (MADV_*).
+ * addr은 페이지 정렬되어야 하며 범위 전체가 매핑되어 있어야 한다.
+ * 성공하면 0, 실패하면 -1을 반환한다. */
+int madvise(void *addr, size_t length, int advice)
+{
+	return syscall3(SYS_MADVISE, addr, length, advice);
+}
+
+/* mincore:
+ * [addr, addr + length)의 각 페이지가 지금 메모리에 올라와 있으면 vec의 해당 바이트를 1,
+ * 아니면 0으로 채운다. addr은 페이지 정렬되어야 하며 범위 전체가 매핑되어 있어야 한다.
+ * 성공하면 0, 실패하면 -1을 반환한다. */
+int mincore(void *addr, size_t length, unsigned char *vec)
+{
+	return syscall3(SYS_MINCORE, addr, length, vec);
+}
+
+/* sbrk:
+ * 힙의 끝(program break)을 increment 바이트만큼 옮기고 이전 끝 주소를 반환한다.
+ * 늘린 부분은 처음 접근할 때 0으로 채워진 페이지가 되며, 줄인 부분은 바로 해제된다.
+ * 실패하면 (void *) -1을 반환한다. */
+void *sbrk(intptr_t increment)
+{
+	return (void *)syscall1(SYS_SBRK, increment);
+}
+
+/* msync:
+ * [addr, addr + length)의 파일 매핑에서 수정된 페이지를 매핑을 유지한 채 파일에 기록한다.
+ * addr은 페이지 정렬되어 있어야 하며, 범위에 매핑되지 않은 주소가 있으면 -1을 반환한다. */
+int msync(void *addr, size_t length)
+{
+	return syscall2(SYS_MSYNC, addr, length);
+}
+
+/* get_vmstat:
+ * 커널이 부팅 후 모은 폴트 종류별 횟수와 지연 시간 히스토그램, 페이지 타입별 교체 통계를
+ * st에 복사한다. 성공하면 0을 반환한다. */
+int get_vmstat(struct vmstat *st)
+{
+	return syscall1(SYS_VMSTAT, st);
+}
+
+/* set_rss_limit:
+ * 이 프로세스가 프레임에 올려 둘 수 있는 페이지 수를 pages로 제한한다. 0이면 제한을 없앤다.
+ * 상한에 닿으면 다른 프로세스 대신 자기 페이지부터 내보낸다. 상한은 fork, spawn, exec에서
+ * 이어지며, 너무 작은 값은 커널이 정한 최솟값으로 올라간다. 성공하면 0을 반환한다. */
+int set_rss_limit(size_t pages)
+{
+	return syscall1(SYS_SET_RSS_LIMIT, pages);
+}
+
+/* get_rss:
+ * 이 프로세스에서 지금 프레임에 올라와 있는 페이지 수를 반환한다. */
+size_t get_rss(void)
+{
+	return syscall0(SYS_GET_RSS);
+}
+
 bool chdir(const char *dir)
 {
 	return syscall1(SYS_CHDIR, dir);
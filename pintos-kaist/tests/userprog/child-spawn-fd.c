@@ -0,0 +1,31 @@
+/* Child process run by spawn-arg test.
+
+   Started with only the console output descriptor and a file
+   that the parent remapped to the descriptor passed as the first
+   command-line argument.  Checks that descriptor 0 is closed and
+   that the remapped descriptor reads the parent's file. */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+
+const char *test_name = "child-spawn-fd";
+
+int
+main (int argc UNUSED, char *argv[]) 
+{
+  char c;
+
+  msg ("begin");
+
+  if (!isdigit (*argv[1]))
+    fail ("bad command-line arguments");
+
+  CHECK (read (0, &c, 1) == -1, "read from closed fd 0 fails");
+  check_file_handle (atoi (argv[1]), "sample.txt", sample, sizeof sample - 1);
+  msg ("end");
+
+  return 0;
+}
@@ -0,0 +1,30 @@
+/* Starts a child with spawn, passing it an argument and only the
+   console output descriptor, and waits for it.  Then starts a
+   second child with an opened file remapped to descriptor 5 and
+   descriptor 0 left closed, and lets it check both. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int fd_map[] = { -1, 1 };
+  int file_map[] = { -1, 1, -1, -1, -1, -1 };
+  int handle;
+  pid_t pid;
+
+  msg ("I'm your father");
+  pid = spawn ("child-args childarg", fd_map, 2);
+  if (pid == PID_ERROR)
+    fail ("spawn \"child-args childarg\"");
+  CHECK (wait (pid) == 0, "wait for child");
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  file_map[5] = handle;
+  pid = spawn ("child-spawn-fd 5", file_map, 6);
+  if (pid == PID_ERROR)
+    fail ("spawn \"child-spawn-fd 5\"");
+  CHECK (wait (pid) == 0, "wait for child-spawn-fd");
+}
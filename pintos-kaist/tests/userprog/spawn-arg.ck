@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-arg) begin
+(spawn-arg) I'm your father
+(args) begin
+(args) argc = 2
+(args) argv[0] = 'child-args'
+(args) argv[1] = 'childarg'
+(args) argv[2] = null
+(args) end
+child-args: exit(0)
+(spawn-arg) wait for child
+(spawn-arg) open "sample.txt"
+(child-spawn-fd) begin
+(child-spawn-fd) read from closed fd 0 fails
+(child-spawn-fd) verified contents of "sample.txt"
+(child-spawn-fd) end
+child-spawn-fd: exit(0)
+(spawn-arg) wait for child-spawn-fd
+(spawn-arg) end
+spawn-arg: exit(0)
+EOF
+pass;
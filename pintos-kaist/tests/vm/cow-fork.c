@@ -0,0 +1,46 @@
+/* Fills a buffer, forks, and has parent and child each overwrite
+   their copy with a different pattern.  Pages are shared
+   copy-on-write after fork, so neither process may see the
+   other's writes. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define BUF_SIZE (128 * PAGE_SIZE)
+
+static char buf[BUF_SIZE];
+
+static void
+check (char expected, const char *who)
+{
+  size_t i;
+
+  for (i = 0; i < BUF_SIZE; i += PAGE_SIZE)
+    if (buf[i] != expected)
+      fail ("%s: page %zu is %d, expected %d",
+            who, i / PAGE_SIZE, buf[i], expected);
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  memset (buf, 'a', BUF_SIZE);
+  child = fork ("cow-fork");
+  if (child == 0)
+    {
+      check ('a', "child");
+      memset (buf, 'c', BUF_SIZE);
+      check ('c', "child");
+      exit (81);
+    }
+
+  memset (buf, 'p', BUF_SIZE);
+  CHECK (wait (child) == 81, "wait for child");
+  check ('p', "parent");
+  msg ("parent's pages intact");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-fork) begin
+(cow-fork) wait for child
+(cow-fork) parent's pages intact
+(cow-fork) end
+EOF
+pass;
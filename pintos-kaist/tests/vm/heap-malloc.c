@@ -0,0 +1,69 @@
+/* Checks sbrk(), anonymous mmap() and the user malloc(): new
+   heap and anonymous pages read as zero, are not resident until
+   touched, and memory handed out by malloc() survives frees of
+   its neighbours and is given back to the kernel once freed. */
+
+#include <malloc.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_CNT 64
+
+static char *blocks[BLOCK_CNT];
+
+static size_t
+block_len (int i)
+{
+  return 8 + (size_t) i * 131;
+}
+
+void
+test_main (void)
+{
+  char *anon = (char *) 0x10000000;
+  unsigned char vec[4];
+  char *brk;
+  int i;
+
+  CHECK ((brk = sbrk (2 * 4096)) != (void *) -1, "sbrk grow");
+  if (brk[0] != 0 || brk[2 * 4096 - 1] != 0)
+    fail ("new heap page not zeroed");
+  brk[4096] = 'h';
+  CHECK (sbrk (-2 * 4096) == brk + 2 * 4096, "sbrk shrink");
+
+  CHECK (mmap (anon, 4 * 4096, 1, MAP_ANONYMOUS, 0) == anon, "mmap anonymous");
+  CHECK (mincore (anon, 4 * 4096, vec) == 0, "mincore");
+  if (vec[0] || vec[1] || vec[2] || vec[3])
+    fail ("anonymous page resident before first access");
+  anon[2 * 4096] = 'a';
+  if (anon[0] != 0 || anon[2 * 4096] != 'a')
+    fail ("anonymous mapping has wrong contents");
+  munmap (anon);
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      blocks[i] = malloc (block_len (i));
+      if (blocks[i] == NULL)
+        fail ("malloc %zu bytes failed", block_len (i));
+      memset (blocks[i], i, block_len (i));
+    }
+  for (i = 0; i < BLOCK_CNT; i += 2)
+    free (blocks[i]);
+  for (i = 1; i < BLOCK_CNT; i += 2)
+    {
+      size_t j;
+      for (j = 0; j < block_len (i); j++)
+        if (blocks[i][j] != (char) i)
+          fail ("block %d corrupted at byte %zu", i, j);
+    }
+  msg ("malloc and free");
+
+  blocks[1] = realloc (blocks[1], 20000);
+  if (blocks[1] == NULL || blocks[1][block_len (1) - 1] != 1)
+    fail ("realloc lost contents");
+  for (i = 1; i < BLOCK_CNT; i += 2)
+    free (blocks[i]);
+  CHECK (sbrk (0) == brk, "heap returned after free");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(heap-malloc) begin
+(heap-malloc) sbrk grow
+(heap-malloc) sbrk shrink
+(heap-malloc) mmap anonymous
+(heap-malloc) mincore
+(heap-malloc) malloc and free
+(heap-malloc) heap returned after free
+(heap-malloc) end
+EOF
+pass;
@@ -0,0 +1,104 @@
+/* Run with -huge-pages.  Maps two adjacent 2 MB anonymous regions
+   at 2 MB aligned addresses and checks that the first write maps
+   each of them with a single huge page.  Then forks, so the huge
+   pages must be split and shared copy-on-write, and has parent and
+   child overwrite both regions with different patterns.  Finally
+   drops part of one huge page with MADV_DONTNEED and unmaps the
+   second region, checking that the rest is left intact. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+#define REGION_SIZE (2 * HUGE_SIZE)
+#define PAGE_CNT (REGION_SIZE / PAGE_SIZE)
+#define HUGE_PAGE_CNT (HUGE_SIZE / PAGE_SIZE)
+#define DROP_START (HUGE_SIZE / 2)      /* Offset of the dropped range. */
+#define DROP_SIZE (64 * PAGE_SIZE)
+
+static char * const region = (char *) 0x10000000;
+
+/* Fills page I of the region with I + DELTA. */
+static void
+fill (int delta)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    region[i * PAGE_SIZE] = (char) (i + delta);
+}
+
+/* Checks that page I of the first CNT pages of the region holds
+   I + DELTA, or zero if it lies in the dropped range and DROPPED
+   is true. */
+static void
+check (size_t cnt, int delta, bool dropped, const char *who)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      size_t ofs = i * PAGE_SIZE;
+      char expected = (char) (i + delta);
+      if (dropped && ofs >= DROP_START && ofs < DROP_START + DROP_SIZE)
+        expected = 0;
+      if (region[ofs] != expected)
+        fail ("%s: page %zu is %d, expected %d", who, i, region[ofs], expected);
+    }
+}
+
+/* Checks that the 2 MB at OFS are backed by one aligned run of
+   physical memory. */
+static void
+check_huge (size_t ofs)
+{
+  uintptr_t base = (uintptr_t) get_phys_addr (region + ofs);
+  size_t i;
+
+  if (base % HUGE_SIZE != 0)
+    fail ("2 MB at offset %zu not backed by an aligned huge page", ofs);
+  for (i = 0; i < HUGE_SIZE; i += PAGE_SIZE)
+    if ((uintptr_t) get_phys_addr (region + ofs + i) != base + i)
+      fail ("page at offset %zu not in the huge page", ofs + i);
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  CHECK (mmap (region, HUGE_SIZE, 1, MAP_ANONYMOUS, 0) == region,
+         "mmap first 2 MB anonymous region");
+  CHECK (mmap (region + HUGE_SIZE, HUGE_SIZE, 1, MAP_ANONYMOUS, 0)
+         == region + HUGE_SIZE, "mmap second 2 MB anonymous region");
+  fill (0);
+  check_huge (0);
+  check_huge (HUGE_SIZE);
+  msg ("regions mapped with huge pages");
+
+  child = fork ("huge-pages");
+  if (child == 0)
+    {
+      check (PAGE_CNT, 0, false, "child");
+      fill (1);
+      check (PAGE_CNT, 1, false, "child");
+      exit (81);
+    }
+  fill (2);
+  CHECK (wait (child) == 81, "wait for child");
+  check (PAGE_CNT, 2, false, "parent");
+  msg ("parent's pages intact");
+
+  CHECK (madvise (region + DROP_START, DROP_SIZE, MADV_DONTNEED) == 0,
+         "madvise part of a huge page away");
+  check (PAGE_CNT, 2, true, "parent");
+  msg ("rest of the regions intact");
+
+  munmap (region + HUGE_SIZE);
+  check (HUGE_PAGE_CNT, 2, true, "parent");
+  msg ("first region intact after unmapping the second");
+  munmap (region);
+}
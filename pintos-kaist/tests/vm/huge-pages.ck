@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(huge-pages) begin
+(huge-pages) mmap first 2 MB anonymous region
+(huge-pages) mmap second 2 MB anonymous region
+(huge-pages) regions mapped with huge pages
+(huge-pages) wait for child
+(huge-pages) parent's pages intact
+(huge-pages) madvise part of a huge page away
+(huge-pages) rest of the regions intact
+(huge-pages) first region intact after unmapping the second
+(huge-pages) end
+EOF
+pass;
@@ -0,0 +1,51 @@
+/* Checks madvise() and mincore() on a file mapping: WILLNEED
+   brings the page in without a fault, DONTNEED drops it after
+   writing it back, and the next access sees the written data.
+   Also checks that bad ranges and code segments are refused. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static bool
+resident (void *addr)
+{
+  unsigned char vec;
+
+  CHECK (mincore (addr, 4096, &vec) == 0, "mincore");
+  return vec != 0;
+}
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  void *code = (void *) ((uintptr_t) test_main & ~(uintptr_t) 0xfff);
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (actual, 4096, 1, handle, 0) != MAP_FAILED, "mmap \"sample.txt\"");
+
+  if (resident (actual))
+    fail ("page resident before first access");
+  CHECK (madvise (actual, 4096, MADV_WILLNEED) == 0, "madvise WILLNEED");
+  if (!resident (actual))
+    fail ("page not resident after WILLNEED");
+
+  actual[0] = 'X';
+  CHECK (madvise (actual, 4096, MADV_DONTNEED) == 0, "madvise DONTNEED");
+  if (resident (actual))
+    fail ("page still resident after DONTNEED");
+  if (actual[0] != 'X' || memcmp (actual + 1, sample + 1, strlen (sample) - 1))
+    fail ("dropped page lost its contents");
+
+  CHECK (madvise (actual + 1, 4096, MADV_NORMAL) == -1, "madvise unaligned");
+  CHECK (madvise (actual, 2 * 4096, MADV_RANDOM) == -1, "madvise past mapping");
+  CHECK (madvise (code, 4096, MADV_DONTNEED) == -1, "madvise DONTNEED on code");
+
+  munmap (actual);
+  close (handle);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise) begin
+(madvise) open "sample.txt"
+(madvise) mmap "sample.txt"
+(madvise) mincore
+(madvise) madvise WILLNEED
+(madvise) mincore
+(madvise) madvise DONTNEED
+(madvise) mincore
+(madvise) madvise unaligned
+(madvise) madvise past mapping
+(madvise) madvise DONTNEED on code
+(madvise) end
+EOF
+pass;
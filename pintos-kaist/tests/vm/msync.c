@@ -0,0 +1,36 @@
+/* Writes to a file through a mapping and calls msync(), then
+   reads the file back with read() while the mapping is still in
+   place.  The page must stay resident, and msync() must refuse
+   unaligned and unmapped ranges. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+
+void
+test_main (void)
+{
+  int handle;
+  unsigned char vec;
+  char buf[1024];
+
+  CHECK (create ("sample.txt", strlen (sample)), "create \"sample.txt\"");
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (ACTUAL, 4096, 1, handle, 0) != MAP_FAILED, "mmap \"sample.txt\"");
+  memcpy (ACTUAL, sample, strlen (sample));
+  CHECK (msync (ACTUAL, 4096) == 0, "msync");
+
+  CHECK (mincore (ACTUAL, 4096, &vec) == 0 && vec, "page still resident");
+  read (handle, buf, strlen (sample));
+  CHECK (!memcmp (buf, sample, strlen (sample)),
+         "compare read data against written data");
+
+  CHECK (msync ((char *) ACTUAL + 1, 4096) == -1, "msync unaligned");
+  CHECK (msync (ACTUAL, 2 * 4096) == -1, "msync past mapping");
+  munmap (ACTUAL);
+  close (handle);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(msync) begin
+(msync) create "sample.txt"
+(msync) open "sample.txt"
+(msync) mmap "sample.txt"
+(msync) msync
+(msync) page still resident
+(msync) compare read data against written data
+(msync) msync unaligned
+(msync) msync past mapping
+(msync) end
+EOF
+pass;
@@ -0,0 +1,39 @@
+/* Caps the process's resident set with set_rss_limit(), then
+   writes more heap pages than the cap allows.  The process must
+   stay within the cap by evicting its own pages, and every page
+   must still read back correctly afterward. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define LIMIT 64
+#define PAGE_CNT 256
+
+void
+test_main (void)
+{
+  char *heap;
+  size_t rss;
+  int i;
+
+  CHECK (set_rss_limit (LIMIT) == 0, "set_rss_limit");
+  CHECK ((heap = sbrk (PAGE_CNT * 4096)) != (void *) -1, "sbrk");
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (heap + i * 4096, i, 4096);
+  rss = get_rss ();
+  if (rss > LIMIT)
+    fail ("%zu resident pages after writing, limit %d", rss, LIMIT);
+  msg ("writes stay within the limit");
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if (heap[i * 4096] != (char) i || heap[i * 4096 + 4095] != (char) i)
+      fail ("page %d has wrong contents", i);
+  rss = get_rss ();
+  if (rss > LIMIT)
+    fail ("%zu resident pages after reading, limit %d", rss, LIMIT);
+  msg ("reads stay within the limit");
+
+  CHECK (set_rss_limit (0) == 0, "remove limit");
+}
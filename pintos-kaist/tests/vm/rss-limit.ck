@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(rss-limit) begin
+(rss-limit) set_rss_limit
+(rss-limit) sbrk
+(rss-limit) writes stay within the limit
+(rss-limit) reads stay within the limit
+(rss-limit) remove limit
+(rss-limit) end
+EOF
+pass;
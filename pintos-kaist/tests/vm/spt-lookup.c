@@ -0,0 +1,49 @@
+/* Builds a large address space (a 16 MB bss region plus a file
+   mapping far above it), then issues many mincore() system calls
+   over a window of 256 resident pages.  Each call looks every page
+   of the window up in the supplemental page table, so the run time
+   is dominated by SPT lookups.  Used by vm/bench.sh as a
+   microbenchmark. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define SPACE_SIZE (16 * 1024 * 1024)
+#define WINDOW_PAGES 256
+#define ROUNDS 1000
+
+static char space[SPACE_SIZE];
+static unsigned char vec[WINDOW_PAGES];
+
+void
+test_main (void)
+{
+  char *window = space + SPACE_SIZE / 2;
+  char *actual = (char *) 0x10000000;
+  int handle;
+  size_t i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (actual, PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+
+  msg ("touch window");
+  for (i = 0; i < WINDOW_PAGES; i++)
+    window[i * PAGE_SIZE] = (char) i;
+
+  msg ("mincore window %d times", ROUNDS);
+  for (i = 0; i < ROUNDS; i++)
+    if (mincore (window, WINDOW_PAGES * PAGE_SIZE, vec) != 0)
+      fail ("mincore failed");
+
+  for (i = 0; i < WINDOW_PAGES; i++)
+    if (!vec[i])
+      fail ("window page %zu not resident", i);
+  for (i = 0; i < WINDOW_PAGES; i++)
+    if (window[i * PAGE_SIZE] != (char) i)
+      fail ("window byte %zu changed", i * PAGE_SIZE);
+  msg ("window intact");
+}
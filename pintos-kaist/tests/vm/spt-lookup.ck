@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(spt-lookup) begin
+(spt-lookup) open "sample.txt"
+(spt-lookup) mmap "sample.txt"
+(spt-lookup) touch window
+(spt-lookup) mincore window 1000 times
+(spt-lookup) window intact
+(spt-lookup) end
+EOF
+pass;
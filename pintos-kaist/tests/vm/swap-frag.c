@@ -0,0 +1,59 @@
+/* Run with -swap-check, which first checks that a 3-slot cluster
+   fits a 3-slot free extent of a fragmented swap space.  Then
+   fragments swap for real: Pintos memory is 10 MB, so writing the
+   first 20 MB anonymous region swaps most of it out, and dropping
+   three of every four pages with MADV_DONTNEED leaves 3-slot holes
+   between the kept pages.  Writing the second region must swap out
+   into those holes without disturbing the kept pages. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define REGION_SIZE (20 * 1024 * 1024)
+#define PAGE_CNT (REGION_SIZE / PAGE_SIZE)
+
+static char * const first = (char *) 0x10000000;
+static char * const second = (char *) 0x20000000;
+
+void
+test_main (void)
+{
+  size_t i;
+
+  CHECK (mmap (first, REGION_SIZE, 1, MAP_ANONYMOUS, 0) == first,
+         "mmap first anonymous region");
+  CHECK (mmap (second, REGION_SIZE, 1, MAP_ANONYMOUS, 0) == second,
+         "mmap second anonymous region");
+
+  msg ("write the first region");
+  for (i = 0; i < PAGE_CNT; i++)
+    first[i * PAGE_SIZE] = (char) i;
+
+  msg ("drop three of every four pages");
+  for (i = 0; i < PAGE_CNT; i += 4)
+    if (madvise (first + (i + 1) * PAGE_SIZE, 3 * PAGE_SIZE,
+                 MADV_DONTNEED) != 0)
+      fail ("madvise DONTNEED at page %zu", i + 1);
+
+  msg ("write the second region");
+  for (i = 0; i < PAGE_CNT; i++)
+    second[i * PAGE_SIZE] = (char) (i + 1);
+
+  msg ("check both regions");
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      char expected = i % 4 == 0 ? (char) i : 0;
+      if (first[i * PAGE_SIZE] != expected)
+        fail ("first region page %zu is %d, expected %d", i,
+              first[i * PAGE_SIZE], expected);
+      if (second[i * PAGE_SIZE] != (char) (i + 1))
+        fail ("second region page %zu is %d, expected %d", i,
+              second[i * PAGE_SIZE], (char) (i + 1));
+    }
+
+  munmap (second);
+  munmap (first);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+fail "missing swap allocator check\n"
+  if !grep ($_ eq 'swap check: 3-slot cluster fits a fragmented 3-slot extent',
+	    @output);
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-frag) begin
+(swap-frag) mmap first anonymous region
+(swap-frag) mmap second anonymous region
+(swap-frag) write the first region
+(swap-frag) drop three of every four pages
+(swap-frag) write the second region
+(swap-frag) check both regions
+(swap-frag) end
+EOF
+pass;
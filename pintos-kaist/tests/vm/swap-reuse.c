@@ -0,0 +1,52 @@
+/* Checks that an anonymous page read back from swap may be
+   dropped again without being rewritten, but not after it has
+   been modified.  Pintos memory is 10 MB, so every pass over the
+   20 MB region evicts the pages touched earlier.  The second pass
+   only reads, so its pages keep their swap slots and are dropped
+   clean; the third pass then overwrites every page, so the kept
+   slots become stale and the last pass must see the new data. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_SIZE (20 * 1024 * 1024)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+/* Checks that every page of the region holds DELTA plus its
+   page number. */
+static void
+check_pages (int delta)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    if (big_chunks[i * PAGE_SIZE] != (char) (i + delta))
+      fail ("page %zu: expected %d, got %d", i, (char) (i + delta),
+            big_chunks[i * PAGE_SIZE]);
+}
+
+void
+test_main (void)
+{
+  size_t i;
+
+  msg ("write every page");
+  for (i = 0; i < PAGE_COUNT; i++)
+    big_chunks[i * PAGE_SIZE] = (char) i;
+
+  msg ("read every page");
+  check_pages (0);
+
+  msg ("overwrite every page");
+  for (i = 0; i < PAGE_COUNT; i++)
+    big_chunks[i * PAGE_SIZE] = (char) (i + 1);
+
+  msg ("read every page again");
+  check_pages (1);
+}
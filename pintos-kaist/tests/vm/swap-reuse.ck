@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-reuse) begin
+(swap-reuse) write every page
+(swap-reuse) read every page
+(swap-reuse) overwrite every page
+(swap-reuse) read every page again
+(swap-reuse) end
+EOF
+pass;
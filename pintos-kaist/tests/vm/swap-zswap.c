@@ -0,0 +1,61 @@
+/* Run with -zswap=64.  Writes a 20 MB region of easily compressed
+   pages with 10 MB of memory, so evicted pages are compressed into
+   zswap until its arena fills and the oldest entries are written
+   back to the swap disk.  Then forks: the child inherits the pages
+   still in zswap by duplicating their entries and the pages already
+   on disk by sharing their slots.  Both processes read every page
+   back and check it. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_SIZE (20 * 1024 * 1024)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+#define STAMP_CNT 8
+
+static char big_chunks[CHUNK_SIZE];
+
+/* Checks that every page of the region carries its own stamp. */
+static void
+check_pages (const char *who)
+{
+  size_t i, j;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    {
+      uint32_t *stamp = (uint32_t *) (big_chunks + i * PAGE_SIZE);
+      for (j = 0; j < STAMP_CNT; j++)
+        if (stamp[j] != i * STAMP_CNT + j)
+          fail ("%s: page %zu is inconsistent", who, i);
+    }
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+  size_t i, j;
+
+  /* Only a few words per page, so every page compresses well. */
+  msg ("write every page");
+  for (i = 0; i < PAGE_COUNT; i++)
+    {
+      uint32_t *stamp = (uint32_t *) (big_chunks + i * PAGE_SIZE);
+      for (j = 0; j < STAMP_CNT; j++)
+        stamp[j] = i * STAMP_CNT + j;
+    }
+
+  child = fork ("swap-zswap");
+  if (child == 0)
+    {
+      check_pages ("child");
+      exit (81);
+    }
+  CHECK (wait (child) == 81, "wait for child");
+  check_pages ("parent");
+  msg ("parent's pages intact");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-zswap) begin
+(swap-zswap) write every page
+(swap-zswap) wait for child
+(swap-zswap) parent's pages intact
+(swap-zswap) end
+EOF
+pass;
@@ -0,0 +1,80 @@
+/* Microbenchmark for TLB handling across address-space switches
+   and bulk unmaps.  Not a pass/fail test: compare its cycle counts
+   and the kernel's "TLB:" statistics line between runs, e.g.
+
+     pintos --cpu qemu64,+pcid -- -q run tlb-bench
+     pintos --cpu qemu64,+pcid -- -q -no-pcid run tlb-bench
+
+   The first part runs a parent and a child that both keep
+   re-touching a small working set while the timer preempts them,
+   so each switch either keeps or loses the other's TLB entries.
+   The second part repeatedly maps, touches and unmaps an anonymous
+   region, which invalidates one batch of pages per munmap(). */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define WS_PAGES 64            /* Working set of each process. */
+#define WS_ROUNDS 20000        /* Passes over the working set. */
+#define UNMAP_PAGES 256        /* Pages per mapping in the munmap part. */
+#define UNMAP_ROUNDS 32
+
+static char ws[WS_PAGES * PAGE_SIZE];
+
+static inline uint64_t
+rdtsc (void)
+{
+  uint32_t lo, hi;
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+/* Touches every page of the working set ROUNDS times and
+   returns the cycles it took. */
+static uint64_t
+touch_ws (int rounds)
+{
+  uint64_t start = rdtsc ();
+  for (int r = 0; r < rounds; r++)
+    for (int i = 0; i < WS_PAGES; i++)
+      ws[i * PAGE_SIZE] += r;
+  return rdtsc () - start;
+}
+
+void
+test_main (void)
+{
+  char *addr = (char *) 0x10000000;
+  uint64_t cycles, total;
+  pid_t pid;
+
+  /* Fault the working set in before timing. */
+  touch_ws (1);
+  if ((pid = fork ("child")) == 0)
+    {
+      touch_ws (WS_ROUNDS);
+      exit (0);
+    }
+  CHECK (pid > 0, "fork");
+  cycles = touch_ws (WS_ROUNDS);
+  wait (pid);
+  msg ("switch: %llu cycles per pass over %d pages",
+       (unsigned long long) (cycles / WS_ROUNDS), WS_PAGES);
+
+  total = 0;
+  for (int r = 0; r < UNMAP_ROUNDS; r++)
+    {
+      CHECK (mmap (addr, UNMAP_PAGES * PAGE_SIZE, 1, MAP_ANONYMOUS, 0) == addr,
+             "mmap");
+      for (int i = 0; i < UNMAP_PAGES; i++)
+        addr[i * PAGE_SIZE] = i;
+      cycles = rdtsc ();
+      munmap (addr);
+      total += rdtsc () - cycles;
+    }
+  msg ("munmap: %llu cycles per %d-page unmap",
+       (unsigned long long) (total / UNMAP_ROUNDS), UNMAP_PAGES);
+}
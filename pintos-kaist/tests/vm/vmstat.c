@@ -0,0 +1,34 @@
+/* Checks that get_vmstat() counts page faults by class: first
+   writes to fresh heap pages are demand-zero faults with a
+   recorded latency, and none of them is counted as bogus. */
+
+#include <string.h>
+#include <syscall.h>
+#include <vmstat.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_CNT 8
+
+static struct vmstat before, after;
+
+void
+test_main (void)
+{
+  char *heap;
+  int i;
+
+  CHECK ((heap = sbrk (PAGE_CNT * 4096)) != (void *) -1, "sbrk");
+  CHECK (get_vmstat (&before) == 0, "get_vmstat");
+  for (i = 0; i < PAGE_CNT; i++)
+    heap[i * 4096] = 1;
+  CHECK (get_vmstat (&after) == 0, "get_vmstat");
+
+  if (after.faults[VMSTAT_FAULT_ZERO].cnt - before.faults[VMSTAT_FAULT_ZERO].cnt < PAGE_CNT)
+    fail ("demand-zero faults not counted");
+  if (after.faults[VMSTAT_FAULT_ZERO].cycles <= before.faults[VMSTAT_FAULT_ZERO].cycles)
+    fail ("demand-zero fault latency not recorded");
+  if (after.faults[VMSTAT_FAULT_BOGUS].cnt != before.faults[VMSTAT_FAULT_BOGUS].cnt)
+    fail ("unexpected bogus fault");
+  msg ("fault counters");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vmstat) begin
+(vmstat) sbrk
+(vmstat) get_vmstat
+(vmstat) get_vmstat
+(vmstat) fault counters
+(vmstat) end
+EOF
+pass;
@@ -31,6 +31,9 @@
 #include "tests/threads/tests.h"
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/zswap.h"
+#include "vm/evict.h"
+#include "vm/swap.h"
 #endif
 #ifdef FILESYS
 #include "devices/disk.h"
@@ -85,6 +88,7 @@ int main(void)
 	mem_end = palloc_init(); // 페이지 할당자 초기화 (유저/커널 페이지 풀)
 	malloc_init();			 // 커널 heap 초기화
 	paging_init(mem_end);	 // 페이지 테이블 설정 (커널 초기 매핑 포함)
+	mmu_init();				 // 페이지 테이블 점유 카운트 준비
 
 #ifdef USERPROG
 	/* 6. 사용자 프로그램 실행을 위한 환경 설정 */
@@ -237,6 +241,31 @@ parse_options(char **argv)
 			user_page_limit = atoi(value);
 		else if (!strcmp(name, "-threads-tests"))
 			thread_tests = true;
+		else if (!strcmp(name, "-no-pcid"))
+			pcid_enabled = false;
+#endif
+#ifdef VM
+		else if (!strcmp(name, "-wm-low"))
+			reclaim_low_wm = atoi(value);
+		else if (!strcmp(name, "-wm-high"))
+			reclaim_high_wm = atoi(value);
+		else if (!strcmp(name, "-zswap"))
+			zswap_pages = atoi(value);
+		else if (!strcmp(name, "-fault-around"))
+			fault_around_pages = atoi(value);
+		else if (!strcmp(name, "-huge-pages"))
+			huge_pages = true;
+		else if (!strcmp(name, "-swap-check"))
+			swap_check = true;
+		else if (!strcmp(name, "-flush"))
+			flush_interval = atoi(value);
+		else if (!strcmp(name, "-rss-limit"))
+			rss_limit_default = atoi(value);
+		else if (!strcmp(name, "-evict"))
+		{
+			if (value == NULL || !evict_set_policy(value))
+				PANIC("unknown eviction policy `%s' (use -h for help)", value != NULL ? value : "");
+		}
 #endif
 		else
 			PANIC("unknown option `%s' (use -h for help)", name);
@@ -346,6 +375,18 @@ usage(void)
 		   "  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 		   "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+		   "  -no-pcid           Flush the whole TLB on every address-space switch.\n"
+#endif
+#ifdef VM
+		   "  -wm-low=COUNT      Wake the reclaim thread below COUNT free frames.\n"
+		   "  -wm-high=COUNT     Let the reclaim thread free up to COUNT frames.\n"
+		   "  -zswap=PAGES       Keep up to PAGES kernel pages of compressed swap.\n"
+		   "  -fault-around=PAGES  Map up to PAGES file pages per lazy-load fault.\n"
+		   "  -huge-pages        Map aligned 2 MB anonymous regions with huge pages.\n"
+		   "  -swap-check        Check the swap slot allocator at startup.\n"
+		   "  -flush=TICKS       Write back dirty mmap pages every TICKS (0 disables).\n"
+		   "  -rss-limit=PAGES   Limit each process to PAGES resident pages.\n"
+		   "  -evict=POLICY      Replace pages with POLICY: clock, fifo, lru, 2q (or arc).\n"
 #endif
 	);
 	power_off();
@@ -373,12 +414,16 @@ print_stats(void)
 {
 	timer_print_stats();
 	thread_print_stats();
+#ifdef VM
+	vm_print_stats();
+#endif
 #ifdef FILESYS
 	disk_print_stats();
 #endif
 	console_print_stats();
 	kbd_print_stats();
 #ifdef USERPROG
+	mmu_print_stats();
 	exception_print_stats();
 #endif
 }
@@ -1,13 +1,236 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
+#include <round.h>
+#include <stdio.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "intrinsic.h"
 
+/* CR4의 PCID 활성화 비트와, CR3에 쓸 때 그 PCID의 TLB 엔트리를 남겨 두라는 비트 */
+#define CR4_PCIDE (1UL << 17)
+#define CR3_NOFLUSH (1UL << 63)
+/* CPUID.01H:ECX에서 PCID를 지원한다는 비트 */
+#define CPUID_PCID (1U << 17)
+/* PCID는 12비트입니다. 0은 커널 페이지 테이블과 PCID를 얻지 못한 주소 공간이 함께 씁니다 */
+#define PCID_CNT 4096
+
+/* 페이지 테이블 페이지마다 붙는 정보. 커널 풀 페이지 번호로 인덱싱합니다.
+ * PDPT, PD, PT에는 0이 아닌 엔트리 수를 세어 두었다가, pml4_clear_page가 엔트리를 지워
+ * 테이블이 비면 그 테이블을 바로 해제합니다. PML4에는 그 주소 공간의 PCID를 둡니다.
+ * mmu_init 이전에 만든 커널 매핑용 테이블은 세지 않습니다. */
+struct table_info
+{
+	uint16_t used; /* PDPT, PD, PT: 0이 아닌 엔트리 수 */
+	uint16_t pcid; /* PML4: TLB 엔트리를 구분하는 PCID (없으면 0) */
+};
+static struct table_info *table_info;
+static uint8_t *table_base;
+static size_t table_cnt;
+
+/* CPU가 PCID를 지원하면 true. "-no-pcid" 옵션으로 끌 수 있습니다 */
+bool pcid_enabled = true;
+/* 사용 중인 PCID와, 다음에 활성화할 때 TLB를 비워야 하는 PCID.
+ * 비활성 주소 공간의 매핑을 바꾸면 invlpg를 쓸 수 없으므로 stale로 표시해 둡니다 */
+static bool pcid_used[PCID_CNT];
+static bool pcid_stale[PCID_CNT];
+static size_t pcid_next = 1;
+
+/* 지연된 TLB 무효화 묶음. 한 번에 한 스레드만 쓰며, 그 스레드의 주소 공간이
+ * 활성화되어 있을 때의 무효화만 모아 두었다가 tlb_batch_end에서 한꺼번에 처리합니다. */
+#define TLB_BATCH_MAX 32
+static struct
+{
+	struct thread *owner; /* 묶음을 연 스레드, 없으면 NULL */
+	int depth;			  /* tlb_batch_begin 중첩 깊이 */
+	size_t cnt;			  /* 모아 둔 주소 수 */
+	bool full;			  /* 주소가 넘쳤거나 테이블을 해제해서 통째로 비워야 함 */
+	uint64_t va[TLB_BATCH_MAX];
+} tlb_batch;
+
+/* 통계 */
+static long long pcid_switch_cnt;  /* TLB를 유지한 채 주소 공간을 바꾼 횟수 */
+static long long tlb_flush_cnt;	   /* TLB를 통째로 비운 횟수 (CR3 쓰기) */
+static long long invlpg_cnt;	   /* 페이지 하나씩 무효화한 횟수 */
+static long long tlb_batched_cnt;  /* 묶음으로 미룬 무효화 수 */
+static long long table_freed_cnt;  /* 비어서 해제한 페이지 테이블 수 */
+
+/* 페이지 테이블 페이지 TABLE의 정보를 반환합니다. */
+static struct table_info *
+table_info_of(uint64_t *table)
+{
+	size_t idx = pg_no(table) - pg_no(table_base);
+	ASSERT(idx < table_cnt);
+	return &table_info[idx];
+}
+
+/* 페이지 테이블 페이지 TABLE의 엔트리 수를 DELTA만큼 바꿉니다. */
+static void
+table_ref(uint64_t *table, int delta)
+{
+	if (table_info != NULL)
+		table_info_of(table)->used += delta;
+}
+
+/* 비어 있는 페이지 테이블 페이지를 하나 할당합니다. */
+static uint64_t *
+table_alloc(void)
+{
+	uint64_t *table = palloc_get_page(PAL_ZERO);
+	if (table != NULL && table_info != NULL)
+		table_info_of(table)->used = 0;
+	return table;
+}
+
+/* 페이지 테이블 정보 배열을 할당하고, CPU가 지원하면 PCID를 켭니다.
+ * paging_init 뒤에 호출해야 합니다. */
+void mmu_init(void)
+{
+	void *base;
+	uint32_t eax, ebx, ecx, edx;
+
+	palloc_kernel_pool_info(&base, &table_cnt);
+	table_base = base;
+	table_info = palloc_get_multiple(PAL_ASSERT | PAL_ZERO,
+									 DIV_ROUND_UP(table_cnt * sizeof *table_info, PGSIZE));
+
+	/* CR4.PCIDE는 CR3의 PCID가 0일 때만 켤 수 있는데, 지금은 base_pml4가 PCID 0으로 활성화되어 있습니다 */
+	cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+	if (!(ecx & CPUID_PCID))
+		pcid_enabled = false;
+	if (pcid_enabled)
+		lcr4(rcr4() | CR4_PCIDE);
+}
+
+/* 새 주소 공간에 줄 PCID를 고릅니다. 모두 쓰고 있으면 0을 반환합니다. */
+static uint16_t
+pcid_alloc(void)
+{
+	enum intr_level old_level = intr_disable();
+	uint16_t pcid = 0;
+
+	for (size_t i = 0; i < PCID_CNT - 1; i++)
+	{
+		size_t p = pcid_next;
+		pcid_next = pcid_next % (PCID_CNT - 1) + 1;
+		if (!pcid_used[p])
+		{
+			pcid_used[p] = true;
+			/* 이전 주인이 남긴 TLB 엔트리가 있을 수 있으므로 처음 활성화할 때 비웁니다 */
+			pcid_stale[p] = true;
+			pcid = p;
+			break;
+		}
+	}
+	intr_set_level(old_level);
+	return pcid;
+}
+
+/* PML4가 쓰는 PCID (없으면 0) */
+static uint16_t
+pml4_pcid(uint64_t *pml4)
+{
+	if (!pcid_enabled || pml4 == base_pml4)
+		return 0;
+	return table_info_of(pml4)->pcid;
+}
+
+/* PML4가 지금 CR3에 올라가 있으면 true. 하위 12비트는 PCID입니다 */
+static bool
+pml4_is_active(uint64_t *pml4)
+{
+	return PTE_ADDR(rcr3()) == vtop(pml4);
+}
+
+/* 현재 스레드가 연 무효화 묶음이 PML4의 무효화를 미룰 수 있으면 true */
+static bool
+tlb_batch_defers(uint64_t *pml4)
+{
+	return tlb_batch.owner == thread_current() && pml4_is_active(pml4);
+}
+
+/* PML4에서 사용자 가상 주소 VA의 TLB 엔트리를 무효화합니다. TABLES가 true이면
+ * VA를 덮던 페이지 테이블을 해제했으므로 페이징 구조 캐시까지 비워야 합니다.
+ * 활성 주소 공간이면 바로 invlpg 하고(invlpg는 페이징 구조 캐시도 비웁니다),
+ * 무효화 묶음이 열려 있으면 묶음에 모아 둡니다. 비활성 주소 공간은 PCID가 없으면
+ * 다음 CR3 쓰기가 비워 주고, 있으면 다음에 활성화할 때 그 PCID를 통째로 비웁니다. */
+static void
+tlb_invalidate(uint64_t *pml4, uint64_t va, bool tables)
+{
+	if (tlb_batch_defers(pml4))
+	{
+		tlb_batched_cnt++;
+		if (tables || tlb_batch.cnt >= TLB_BATCH_MAX)
+			tlb_batch.full = true;
+		else
+			tlb_batch.va[tlb_batch.cnt++] = va;
+	}
+	else if (pml4_is_active(pml4))
+	{
+		invlpg(va);
+		invlpg_cnt++;
+	}
+	else if (pcid_enabled)
+		pcid_stale[pml4_pcid(pml4)] = true;
+}
+
+/* PML4에서 사용자 가상 페이지 UPAGE의 TLB 엔트리를 무효화합니다.
+ * PTE를 직접 고친 뒤 부릅니다. */
+void pml4_invalidate_page(uint64_t *pml4, const void *upage)
+{
+	tlb_invalidate(pml4, (uint64_t)upage, false);
+}
+
+/* 현재 스레드의 TLB 무효화 묶음을 엽니다. tlb_batch_end까지 현재 주소 공간에서
+ * 일어나는 무효화를 모아 두었다가 한 번에 처리하므로, 그 사이에는 무효화한 사용자 주소에
+ * 접근하면 안 됩니다. 중첩할 수 있으며, 다른 스레드가 묶음을 쓰고 있으면 묶지 않습니다. */
+void tlb_batch_begin(void)
+{
+	enum intr_level old_level = intr_disable();
+	if (tlb_batch.owner == NULL)
+	{
+		tlb_batch.owner = thread_current();
+		tlb_batch.cnt = 0;
+		tlb_batch.full = false;
+	}
+	if (tlb_batch.owner == thread_current())
+		tlb_batch.depth++;
+	intr_set_level(old_level);
+}
+
+/* tlb_batch_begin으로 연 묶음을 닫고, 가장 바깥 묶음이면 모아 둔 무효화를 처리합니다.
+ * 주소가 넘쳤으면 현재 PCID의 TLB를 통째로 비웁니다. */
+void tlb_batch_end(void)
+{
+	if (tlb_batch.owner != thread_current() || --tlb_batch.depth > 0)
+		return;
+
+	if (tlb_batch.full)
+	{
+		/* NOFLUSH 비트 없이 CR3를 다시 쓰면 현재 PCID의 엔트리가 모두 비워집니다 */
+		lcr3(rcr3() & ~CR3_NOFLUSH);
+		tlb_flush_cnt++;
+	}
+	else
+		for (size_t i = 0; i < tlb_batch.cnt; i++)
+			invlpg(tlb_batch.va[i]);
+	invlpg_cnt += tlb_batch.full ? 0 : tlb_batch.cnt;
+	tlb_batch.owner = NULL;
+}
+
+/* TLB와 페이지 테이블 통계를 출력합니다. */
+void mmu_print_stats(void)
+{
+	printf("TLB: PCID %s, %lld switches kept TLB, %lld flushes, %lld invlpg, "
+		   "%lld batched, %lld page tables freed\n",
+		   pcid_enabled ? "on" : "off", pcid_switch_cnt, tlb_flush_cnt, invlpg_cnt,
+		   tlb_batched_cnt, table_freed_cnt);
+}
+
 static uint64_t *
 pgdir_walk(uint64_t *pdp, const uint64_t va, int create)
 {
@@ -19,15 +242,21 @@ pgdir_walk(uint64_t *pdp, const uint64_t va, int create)
 		{
 			if (create)
 			{
-				uint64_t *new_page = palloc_get_page(PAL_ZERO);
+				uint64_t *new_page = table_alloc();
 				if (new_page)
+				{
 					pdp[idx] = vtop(new_page) | PTE_U | PTE_W | PTE_P;
+					table_ref(pdp, 1);
+				}
 				else
 					return NULL;
 			}
 			else
 				return NULL;
 		}
+		/* 2MB 대형 페이지는 PDE가 곧 마지막 단계의 엔트리입니다 */
+		if (pdp[idx] & PTE_PS)
+			return &pdp[idx];
 		return (uint64_t *)ptov(PTE_ADDR(pdp[idx]) + 8 * PTX(va));
 	}
 	return NULL;
@@ -46,10 +275,11 @@ pdpe_walk(uint64_t *pdpe, const uint64_t va, int create)
 		{
 			if (create)
 			{
-				uint64_t *new_page = palloc_get_page(PAL_ZERO);
+				uint64_t *new_page = table_alloc();
 				if (new_page)
 				{
 					pdpe[idx] = vtop(new_page) | PTE_U | PTE_W | PTE_P;
+					table_ref(pdpe, 1);
 					allocated = 1;
 				}
 				else
@@ -64,6 +294,7 @@ pdpe_walk(uint64_t *pdpe, const uint64_t va, int create)
 	{
 		palloc_free_page((void *)ptov(PTE_ADDR(pdpe[idx])));
 		pdpe[idx] = 0;
+		table_ref(pdpe, -1);
 	}
 	return pte;
 }
@@ -87,7 +318,7 @@ pml4e_walk(uint64_t *pml4e, const uint64_t va, int create)
 		{
 			if (create)
 			{
-				uint64_t *new_page = palloc_get_page(PAL_ZERO);
+				uint64_t *new_page = table_alloc();
 				if (new_page)
 				{
 					pml4e[idx] = vtop(new_page) | PTE_U | PTE_W | PTE_P;
@@ -118,7 +349,11 @@ pml4_create(void)
 {
 	uint64_t *pml4 = palloc_get_page(0);
 	if (pml4)
+	{
 		memcpy(pml4, base_pml4, PGSIZE);
+		if (pcid_enabled)
+			table_info_of(pml4)->pcid = pcid_alloc();
+	}
 	return pml4;
 }
 
@@ -149,7 +384,7 @@ pgdir_for_each(uint64_t *pdp, pte_for_each_func *func, void *aux,
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++)
 	{
 		uint64_t *pte = ptov((uint64_t *)pdp[i]);
-		if (((uint64_t)pte) & PTE_P)
+		if ((((uint64_t)pte) & PTE_P) && !(pdp[i] & PTE_PS))
 			if (!pt_for_each((uint64_t *)PTE_ADDR(pte), func, aux,
 							 pml4_index, pdp_index, i))
 				return false;
@@ -203,7 +438,8 @@ pgdir_destroy(uint64_t *pdp)
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++)
 	{
 		uint64_t *pte = ptov((uint64_t *)pdp[i]);
-		if (((uint64_t)pte) & PTE_P)
+		/* 대형 페이지의 프레임은 VM이 관리하므로 여기서 해제하지 않습니다 */
+		if ((((uint64_t)pte) & PTE_P) && !(pdp[i] & PTE_PS))
 			pt_destroy(PTE_ADDR(pte));
 	}
 	palloc_free_page((void *)pdp);
@@ -232,14 +468,41 @@ void pml4_destroy(uint64_t *pml4)
 	uint64_t *pdpe = ptov((uint64_t *)pml4[0]);
 	if (((uint64_t)pdpe) & PTE_P)
 		pdpe_destroy((void *)PTE_ADDR(pdpe));
+	/* PCID의 TLB 엔트리는 다음 주인이 처음 활성화할 때 비웁니다 */
+	uint16_t pcid = pml4_pcid(pml4);
+	if (pcid != 0)
+		pcid_used[pcid] = false;
 	palloc_free_page((void *)pml4);
 }
 
 /* Loads page directory PD into the CPU's page directory base
  * register. */
+/* PCID가 켜져 있으면 PML4의 PCID를 함께 올리고, 그 PCID에 남아 있는 TLB 엔트리를
+ * 비우지 않습니다. PCID 0은 여러 주소 공간이 함께 쓰므로 항상 비웁니다. */
 void pml4_activate(uint64_t *pml4)
 {
-	lcr3(vtop(pml4 ? pml4 : base_pml4));
+	if (pml4 == NULL)
+		pml4 = base_pml4;
+	if (!pcid_enabled)
+	{
+		lcr3(vtop(pml4));
+		tlb_flush_cnt++;
+		return;
+	}
+
+	uint16_t pcid = pml4_pcid(pml4);
+	uint64_t cr3 = vtop(pml4) | pcid;
+	if (rcr3() == cr3 && !pcid_stale[pcid])
+		return;
+	if (pcid != 0 && !pcid_stale[pcid])
+	{
+		cr3 |= CR3_NOFLUSH;
+		pcid_switch_cnt++;
+	}
+	else
+		tlb_flush_cnt++;
+	pcid_stale[pcid] = false;
+	lcr3(cr3);
 }
 
 /* pml4에서 사용자 가상 주소 UADDR에 해당하는 물리 주소를 조회합니다.
@@ -253,7 +516,11 @@ pml4_get_page(uint64_t *pml4, const void *uaddr)
 	uint64_t *pte = pml4e_walk(pml4, (uint64_t)uaddr, 0);
 
 	if (pte && (*pte & PTE_P))
+	{
+		if (*pte & PTE_PS)
+			return ptov(PTE_ADDR(*pte)) + ((uint64_t)uaddr & (HUGE_PGSIZE - 1));
 		return ptov(PTE_ADDR(*pte)) + pg_ofs(uaddr);
+	}
 	return NULL;
 }
 
@@ -271,27 +538,133 @@ bool pml4_set_page(uint64_t *pml4, void *upage, void *kpage, bool rw)
 	uint64_t *pte = pml4e_walk(pml4, (uint64_t)upage, 1);
 
 	if (pte)
+	{
+		/* 대형 페이지 안의 4KB 페이지는 먼저 pml4_split_huge_page로 쪼개야 합니다 */
+		ASSERT(!(*pte & PTE_PS));
+		if (*pte == 0)
+			table_ref(pg_round_down(pte), 1);
 		*pte = vtop(kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+	}
 	return pte != NULL;
 }
 
-/* 사용자 가상 페이지 UPAGE를 페이지 디렉토리 PD에서 "존재하지 않음"으로 표시합니다.
- * 이후 페이지에 대한 접근은 페이지 폴트를 발생시킵니다. 페이지 테이블 엔트리의 다른 비트는 유지됩니다.
+/* VA를 덮는 PDE의 주소를 반환합니다. 중간 단계의 테이블이 없으면
+ * CREATE가 true일 때 새로 만들고, 아니면 null 포인터를 반환합니다. */
+static uint64_t *
+pde_walk(uint64_t *pml4, const uint64_t va, int create)
+{
+	uint64_t *table = pml4;
+	int idx[2] = {PML4(va), PDPE(va)};
+
+	for (int level = 0; level < 2; level++)
+	{
+		if (!(table[idx[level]] & PTE_P))
+		{
+			uint64_t *new_page;
+			if (!create || (new_page = table_alloc()) == NULL)
+				return NULL;
+			table[idx[level]] = vtop(new_page) | PTE_U | PTE_W | PTE_P;
+			if (level > 0)
+				table_ref(table, 1);
+		}
+		table = ptov(PTE_ADDR(table[idx[level]]));
+	}
+	return &table[PDX(va)];
+}
+
+/* 2MB 정렬된 사용자 가상 주소 UPAGE부터 2MB를, KPAGE에서 시작하는 물리적으로 연속되고
+ * 2MB 정렬된 유저 풀 페이지들에 PDE 하나(PTE_PS)로 매핑합니다.
+ * 그 범위에 이미 매핑된 4KB 페이지가 있으면 아무것도 바꾸지 않고 false를 반환합니다.
+ * 비어 있는 페이지 테이블이 남아 있으면 해제하고 그 자리를 대신합니다. */
+bool pml4_set_huge_page(uint64_t *pml4, void *upage, void *kpage, bool rw)
+{
+	ASSERT(((uint64_t)upage & (HUGE_PGSIZE - 1)) == 0);
+	ASSERT((vtop(kpage) & (HUGE_PGSIZE - 1)) == 0);
+	ASSERT(is_user_vaddr(upage));
+	ASSERT(pml4 != base_pml4);
+
+	uint64_t *pde = pde_walk(pml4, (uint64_t)upage, 1);
+	if (pde == NULL)
+		return false;
+
+	bool freed = false;
+	if (*pde & PTE_P)
+	{
+		if (*pde & PTE_PS)
+			return false;
+		uint64_t *pt = ptov(PTE_ADDR(*pde));
+		for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++)
+			if (pt[i] & PTE_P)
+				return false;
+		palloc_free_page(pt);
+		freed = true;
+	}
+	else if (*pde == 0)
+		table_ref(pg_round_down(pde), 1);
+	*pde = vtop(kpage) | PTE_PS | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+	tlb_invalidate(pml4, (uint64_t)upage, freed);
+	return true;
+}
+
+/* UPAGE를 덮는 2MB 대형 페이지를 4KB 페이지 512개로 쪼갭니다.
+ * 빈 페이지 PT를 새 페이지 테이블로 쓰며, 각 PTE는 같은 물리 페이지를 가리키고
+ * 권한과 accessed/dirty 비트를 PDE에서 물려받습니다. 실패하지 않습니다. */
+void pml4_split_huge_page(uint64_t *pml4, void *upage, uint64_t *pt)
+{
+	uint64_t *pde = pde_walk(pml4, (uint64_t)upage, 0);
+
+	ASSERT(pde != NULL && (*pde & PTE_P) && (*pde & PTE_PS));
+
+	uint64_t base = PTE_ADDR(*pde);
+	uint64_t flags = *pde & (PTE_P | PTE_W | PTE_U | PTE_A | PTE_D);
+	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++)
+		pt[i] = (base + i * PGSIZE) | flags;
+	if (table_info != NULL)
+		table_info_of(pt)->used = PGSIZE / sizeof(uint64_t *);
+	*pde = vtop(pt) | PTE_U | PTE_W | PTE_P;
+	/* 대형 페이지 안의 아무 주소나 invlpg 하면 그 2MB TLB 엔트리가 비워집니다 */
+	tlb_invalidate(pml4, (uint64_t)upage, false);
+}
+
+/* 사용자 가상 페이지 UPAGE의 페이지 테이블 엔트리를 PML4에서 지웁니다.
+ * 이후 페이지에 대한 접근은 페이지 폴트를 발생시킵니다. 그 결과 비게 된 PT, PD, PDPT는
+ * 차례로 해제하므로, 큰 영역을 매핑했다 해제하기를 반복해도 빈 테이블이 쌓이지 않습니다.
  * UPAGE는 매핑되어 있을 필요가 없습니다. */
 void pml4_clear_page(uint64_t *pml4, void *upage)
 {
-	uint64_t *pte;
+	uint64_t va = (uint64_t)upage;
+	uint64_t *tables[4] = {pml4};
+	int idx[4] = {PML4(va), PDPE(va), PDX(va), PTX(va)};
+	int level;
+
 	ASSERT(pg_ofs(upage) == 0);
 	ASSERT(is_user_vaddr(upage));
+	ASSERT(pml4 != base_pml4);
 
-	pte = pml4e_walk(pml4, (uint64_t)upage, false);
+	/* 엔트리가 있는 가장 아래 단계를 찾습니다. 대형 페이지는 PDE가 마지막 단계입니다 */
+	for (level = 0; level < 3; level++)
+	{
+		uint64_t entry = tables[level][idx[level]];
+		if (!(entry & PTE_P))
+			return;
+		if (entry & PTE_PS)
+			break;
+		tables[level + 1] = ptov(PTE_ADDR(entry));
+	}
+	if (tables[level][idx[level]] == 0)
+		return;
 
-	if (pte != NULL && (*pte & PTE_P) != 0)
+	bool freed = false;
+	tables[level][idx[level]] = 0;
+	while (level > 0 && table_info != NULL && --table_info_of(tables[level])->used == 0)
 	{
-		*pte &= ~PTE_P;
-		if (rcr3() == vtop(pml4))
-			invlpg((uint64_t)upage);
+		palloc_free_page(tables[level]);
+		table_freed_cnt++;
+		freed = true;
+		level--;
+		tables[level][idx[level]] = 0;
 	}
+	tlb_invalidate(pml4, va, freed);
 }
 
 /* 가상 페이지 VPAGE에 대한 PML4의 PTE가 dirty(수정됨) 상태이면 true를 반환합니다.
@@ -315,8 +688,7 @@ void pml4_set_dirty(uint64_t *pml4, const void *vpage, bool dirty)
 		else
 			*pte &= ~(uint32_t)PTE_D;
 
-		if (rcr3() == vtop(pml4))
-			invlpg((uint64_t)vpage);
+		tlb_invalidate(pml4, (uint64_t)vpage, false);
 	}
 }
 
@@ -341,7 +713,6 @@ void pml4_set_accessed(uint64_t *pml4, const void *vpage, bool accessed)
 		else
 			*pte &= ~(uint32_t)PTE_A;
 
-		if (rcr3() == vtop(pml4))
-			invlpg((uint64_t)vpage);
+		tlb_invalidate(pml4, (uint64_t)vpage, false);
 	}
 }
@@ -287,6 +287,41 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 }
 
 
+/* 물리 주소가 ALIGN 페이지 경계에 맞춰진 연속된 빈 페이지 PAGE_CNT개를 얻어
+   그 커널 가상 주소를 반환합니다. 2MB 대형 페이지처럼 하드웨어가 정렬된 물리 영역을
+   요구할 때 씁니다. FLAGS의 의미는 palloc_get_multiple()과 같습니다.
+   조건에 맞는 자리가 없으면 널 포인터를 반환합니다. */
+void *
+palloc_get_multiple_aligned (enum palloc_flags flags, size_t page_cnt, size_t align) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	size_t pool_cnt = bitmap_size (pool->used_map);
+	void *pages = NULL;
+
+	ASSERT (align > 0);
+
+	/* 커널 가상 주소와 물리 주소는 고정된 오프셋만큼 떨어져 있고 그 오프셋은
+	   대형 페이지 경계에 맞춰져 있으므로, 가상 주소로 정렬을 따져도 됩니다. */
+	size_t first = (align - pg_no (pool->base) % align) % align;
+
+	lock_acquire (&pool->lock);
+	for (size_t idx = first; idx + page_cnt <= pool_cnt; idx += align)
+		if (bitmap_none (pool->used_map, idx, page_cnt)) {
+			bitmap_set_multiple (pool->used_map, idx, page_cnt, true);
+			pages = pool->base + PGSIZE * idx;
+			break;
+		}
+	lock_release (&pool->lock);
+
+	if (pages) {
+		if (flags & PAL_ZERO)
+			memset (pages, 0, PGSIZE * page_cnt);
+	} else {
+		if (flags & PAL_ASSERT)
+			PANIC ("palloc_get: out of pages");
+	}
+	return pages;
+}
+
 /* 빈 페이지 한 개를 얻어 그 커널 가상 주소를 반환합니다.
    PAL_USER가 설정되어 있으면 유저 풀에서, 아니면 커널 풀에서 할당합니다.
    FLAGS에 PAL_ZERO가 설정되어 있으면, 페이지를 0으로 초기화합니다.
@@ -330,6 +365,22 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* 유저 풀의 시작 주소를 *BASE에, 페이지 수를 *PAGE_CNT에 저장합니다.
+   VM의 프레임 테이블을 유저 풀 페이지 번호로 인덱싱할 때 사용합니다. */
+void
+palloc_user_pool_info (void **base, size_t *page_cnt) {
+	*base = user_pool.base;
+	*page_cnt = bitmap_size (user_pool.used_map);
+}
+
+/* 커널 풀의 시작 주소를 *BASE에, 페이지 수를 *PAGE_CNT에 저장합니다.
+   페이지 테이블 페이지마다 붙는 정보를 커널 풀 페이지 번호로 인덱싱할 때 사용합니다. */
+void
+palloc_kernel_pool_info (void **base, size_t *page_cnt) {
+	*base = kernel_pool.base;
+	*page_cnt = bitmap_size (kernel_pool.used_map);
+}
+
 /* 풀 P를 START에서 시작하여 END에서 끝나도록 초기화합니다. */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
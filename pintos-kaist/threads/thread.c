@@ -85,9 +85,6 @@ static uint64_t gdt[3] = {0,
 
 fixed_t load_avg = 0;
 
-// vm용 프레임 테이블
-struct list frame_table;
-
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
    general and it is possible in this case only because loader.S
@@ -118,7 +115,6 @@ void thread_init(void)
 	list_init(&ready_list);
 	list_init(&destruction_req);
 	list_init(&all_list);
-	list_init(&frame_table);
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread();
@@ -2,8 +2,10 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/usercopy.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "intrinsic.h"
 
 /* Number of page faults processed. */
@@ -166,6 +168,18 @@ page_fault(struct intr_frame *f)
 	/* Count page faults. */
 	page_fault_cnt++;
 
+	/* 시스템 콜이 사용자 메모리를 복사하다 처리할 수 없는 폴트가 나면
+	 * 복사 함수의 복구 코드로 돌아가 실패를 알립니다 */
+	if (!user && is_user_vaddr(fault_addr))
+	{
+		uintptr_t fixup = usercopy_fixup(f->rip);
+		if (fixup != 0)
+		{
+			f->rip = fixup;
+			return;
+		}
+	}
+
 	/* If the fault is true fault, show info and exit. */
 	dprintf("Page fault at %p: %s error %s page in %s context.\n",
 			fault_addr,
@@ -30,6 +30,8 @@ static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
+static void __do_spawn(void *);
+static bool process_load(void *f_name, struct intr_frame *if_);
 static int parse_args(char *, char *[]);
 static bool setup_stack(struct intr_frame *if_);
 static struct thread *get_my_child(tid_t tid);
@@ -166,6 +168,33 @@ duplicate_pte(uint64_t *pte, void *va, void *aux)
 }
 #endif
 
+/* 부모 PARENT의 fd_table 전체를 현재 프로세스로 복제합니다. */
+static void
+duplicate_fd_table(struct thread *parent)
+{
+   struct thread *current = thread_current();
+
+   for (int fd = 0; fd < MAX_FD; fd++)
+   {
+      if (fd <= 1)
+         current->fd_table[fd] = parent->fd_table[fd];
+      else
+      {
+         if (parent->fd_table[fd] != NULL)
+         {
+            if (parent->fd_table[fd] == STDIN || parent->fd_table[fd] == STDOUT)
+               current->fd_table[fd] = parent->fd_table[fd];
+            else
+               current->fd_table[fd] = file_duplicate(parent->fd_table[fd]);
+         }
+      }
+   }
+   current->fd_idx = parent->fd_idx;
+   /* extra2 */
+   current->stdin_count = parent->stdin_count;
+   current->stdout_count = parent->stdout_count;
+}
+
 /* 부모의 실행 컨텍스트를 복사하는 스레드 함수입니다.
  * 힌트) parent->tf는 프로세스의 사용자 영역 컨텍스트를 저장하지 않습니다.
  *       즉, 이 함수에는 process_fork의 두 번째 인자인 if_를 넘겨야 합니다. */
@@ -207,26 +236,7 @@ __do_fork(void *aux)
    /* 부모의 fd_table을 순회하며 복사 */
    if (parent->fd_idx == MAX_FD)
       goto error;
-
-   for (int fd = 0; fd < MAX_FD; fd++)
-   {
-      if (fd <= 1)
-         current->fd_table[fd] = parent->fd_table[fd];
-      else
-      {
-         if (parent->fd_table[fd] != NULL)
-         {
-            if (parent->fd_table[fd] == STDIN || parent->fd_table[fd] == STDOUT)
-               current->fd_table[fd] = parent->fd_table[fd];
-            else
-               current->fd_table[fd] = file_duplicate(parent->fd_table[fd]);
-         }
-      }
-   }
-   current->fd_idx = parent->fd_idx;
-   /* extra2 */
-   current->stdin_count = parent->stdin_count;
-   current->stdout_count = parent->stdout_count;
+   duplicate_fd_table(parent);
 
    if_.R.rax = 0;
 
@@ -240,9 +250,142 @@ error:
    sys_exit(TID_ERROR);
 }
 
+/* 현재 프로세스의 fd i에 부모 PARENT의 fd FD_MAP[i]를 FD_CNT개까지 복제합니다.
+ * FD_MAP[i]가 음수이면 fd i는 닫힌 채로 두고, FD_CNT 이상의 fd도 모두 닫혀 있습니다.
+ * 부모에서 열려 있지 않은 fd를 가리키면 false를 반환합니다. */
+static bool
+map_fd_table(struct thread *parent, const int *fd_map, size_t fd_cnt)
+{
+   struct thread *current = thread_current();
+
+   /* process_init이 열어 둔 표준 입출력도 FD_MAP을 따릅니다 */
+   current->fd_table[0] = current->fd_table[1] = NULL;
+   current->stdin_count = current->stdout_count = 0;
+
+   for (size_t fd = 0; fd < fd_cnt; fd++)
+   {
+      struct file *file;
+
+      if (fd_map[fd] < 0)
+         continue;
+      if (fd_map[fd] >= MAX_FD || (file = parent->fd_table[fd_map[fd]]) == NULL)
+         return false;
+
+      if (file == STDIN)
+         current->stdin_count++;
+      else if (file == STDOUT)
+         current->stdout_count++;
+      else if ((file = file_duplicate(file)) == NULL)
+         return false;
+      current->fd_table[fd] = file;
+   }
+   return true;
+}
+
+/* CMD_LINE("프로그램 인자...")의 실행 파일로 새 자식 프로세스를 바로 시작합니다.
+ * fork + exec와 달리 부모의 주소 공간(SPT, 페이지 테이블)을 전혀 복제하지 않으므로
+ * 프로세스 생성 비용이 부모의 크기와 무관합니다.
+ * FD_MAP이 NULL이면 fork처럼 부모의 열린 파일을 모두 물려주고,
+ * 아니면 자식의 fd i에 부모의 fd FD_MAP[i]를 물려줍니다 (map_fd_table 참고).
+ * CMD_LINE은 palloc 페이지이며 해제 책임이 넘어옵니다.
+ * 자식이 실행 파일을 불러온 뒤 반환하며, 실패하면 TID_ERROR를 반환합니다. */
+tid_t process_spawn(char *cmd_line, const int *fd_map, size_t fd_cnt)
+{
+   struct thread *parent = thread_current();
+   struct spawn_info info = {
+       .parent = parent,
+       .cmd_line = cmd_line,
+       .fd_map = fd_map,
+       .fd_cnt = fd_cnt,
+   };
+
+   /* 스레드 이름은 프로그램 이름입니다 */
+   char name[16];
+   strlcpy(name, cmd_line, sizeof name);
+   name[strcspn(name, " ")] = '\0';
+
+   tid_t child_tid = thread_create(name, PRI_DEFAULT, __do_spawn, &info);
+   if (child_tid == TID_ERROR)
+   {
+      palloc_free_page(cmd_line);
+      return TID_ERROR;
+   }
+
+   /* 자식은 INFO를 다 쓰고 실행 파일을 불러온 뒤에 깨웁니다 */
+   sema_down(&parent->fork_sema);
+   struct thread *child = get_my_child(child_tid);
+   if (child->exit_status == TID_ERROR)
+      return TID_ERROR;
+   return child_tid;
+}
+
+/* process_spawn으로 만든 자식의 스레드 함수입니다.
+ * 빈 주소 공간에서 시작해 fd만 물려받고 곧바로 실행 파일을 불러옵니다. */
+static void
+__do_spawn(void *aux)
+{
+   struct spawn_info *info = aux;
+   struct thread *parent = info->parent;
+   struct thread *current = thread_current();
+   struct intr_frame if_;
+   bool fds_ok;
+
+#ifdef VM
+   supplemental_page_table_init(&current->spt);
+   current->spt.rss_limit = parent->spt.rss_limit;
+#endif
+   process_init();
+
+   if (info->fd_map == NULL)
+   {
+      duplicate_fd_table(parent);
+      fds_ok = true;
+   }
+   else
+      fds_ok = map_fd_table(parent, info->fd_map, info->fd_cnt);
+
+   if (!fds_ok)
+   {
+      palloc_free_page(info->cmd_line);
+      goto error;
+   }
+   if (!process_load(info->cmd_line, &if_))
+      goto error;
+
+   sema_up(&parent->fork_sema);
+   do_iret(&if_);
+   NOT_REACHED();
+
+error:
+   /* 부모가 깨어나 실패를 확인하기 전에 종료 코드를 기록해 둡니다 */
+   current->exit_status = TID_ERROR;
+   sema_up(&parent->fork_sema);
+   sys_exit(TID_ERROR);
+}
+
 /* 현재 실행 컨텍스트를 f_name으로 전환합니다.
  * 실패 시 -1을 반환합니다. */
 int process_exec(void *f_name)
+{
+   /* intr_frame을 thread 구조체 안의 것을 사용할 수 없습니다.
+    * 이는 현재 스레드가 재스케줄될 때,
+    * 그 실행 정보를 해당 멤버에 저장하기 때문입니다. */
+   struct intr_frame _if;
+
+   if (!process_load(f_name, &_if))
+      return -1;
+
+   // hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)_if.rsp, true);
+   /* 프로세스를 전환합니다. */
+   do_iret(&_if);
+   NOT_REACHED();
+}
+
+/* 현재 주소 공간을 비우고 F_NAME의 실행 파일을 불러와,
+ * 사용자 모드로 진입할 컨텍스트를 IF_에 채웁니다. F_NAME 페이지는 해제합니다.
+ * 실패 시 false를 반환합니다. */
+static bool
+process_load(void *f_name, struct intr_frame *if_)
 {
    char *file_name = f_name;
    char cp_file_name[MAX_BUF];
@@ -262,41 +405,35 @@ int process_exec(void *f_name)
 
    bool success;
 
-   /* intr_frame을 thread 구조체 안의 것을 사용할 수 없습니다.
-    * 이는 현재 스레드가 재스케줄될 때,
-    * 그 실행 정보를 해당 멤버에 저장하기 때문입니다. */
-   struct intr_frame _if;
-   _if.ds = _if.es = _if.ss = SEL_UDSEG;
-   _if.cs = SEL_UCSEG;
-   _if.eflags = FLAG_IF | FLAG_MBS;
+   if_->ds = if_->es = if_->ss = SEL_UDSEG;
+   if_->cs = SEL_UCSEG;
+   if_->eflags = FLAG_IF | FLAG_MBS;
 
    lock_acquire(&filesys_lock);
    struct file *new_file = filesys_open(first_word);
    lock_release(&filesys_lock);
-   /* 현재 컨텍스트를 제거합니다. */
+   /* 현재 컨텍스트를 제거합니다. 상주 페이지 상한은 새 프로그램에도 이어집니다. */
+   size_t rss_limit = thread_current()->spt.rss_limit;
 
    process_cleanup();
 
    supplemental_page_table_init(&thread_current()->spt);
+   thread_current()->spt.rss_limit = rss_limit;
 
    /* 그리고 이진 파일을 로드합니다. */
    ASSERT(cp_file_name != NULL);
-   success = load(cp_file_name, &_if);
+   success = load(cp_file_name, if_);
 
    palloc_free_page(file_name);
    if (!success)
-      return -1;
+      return false;
    /* ======수정이 필요할 수도 있음=== */
    if (new_file == NULL)
-      return -1;
+      return false;
    thread_current()->running_file = new_file;
    /* ==========여기까지 !!========== */
    file_deny_write(thread_current()->running_file);
-
-   // hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)_if.rsp, true);
-   /* 프로세스를 전환합니다. */
-   do_iret(&_if);
-   NOT_REACHED();
+   return true;
 }
 
 static int parse_args(char *target, char *argv[])
@@ -800,7 +937,7 @@ install_page(void *upage, void *kpage, bool writable)
  *
  * 파라미터:
  * - page: 페이지 구조체, 로드 대상 페이지 정보 포함
- * - aux: lazy_load_info 구조체 포인터, 파일 핸들, 읽을 바이트 수, 오프셋 등 로딩 정보 포함
+ * - aux: struct segment 포인터, 페이지가 속한 구간(세그먼트)의 파일 핸들, 오프셋, 읽을 바이트 수
  *
  * 반환값:
  * - 성공 시 true 반환 (페이지 로드 완료)
@@ -814,26 +951,26 @@ bool lazy_load_segment(struct page *page, void *aux)
    // kva는 page 안에 이미 있다
    // 타입별로 다른 초기화 작업을 거쳐야하나?
 
-   // lazy loading에 필요한 정보를 가져옴
-   struct lazy_load_info *lazy_info = (struct lazy_load_info *)aux;
-   struct file *read_file = lazy_info->file;
+   // lazy loading에 필요한 구간 정보를 가져옴 (페이지별 값은 가상 주소로 계산)
+   struct segment *seg = (struct segment *)aux;
+   size_t read_byte = segment_page_read_bytes(seg, page->va);
 
    // 필요한 만큼의 read_byte를 가져옴
-   off_t my_read_byte = file_read_at(read_file, 
+   off_t my_read_byte = file_read_at(seg->file, 
                                     page->frame->kva,       // 실제 물리 메모리 주소 
-                                    lazy_info->readbyte,    // 읽어야 할 바이트 수
-                                    lazy_info->offset);     // 파일 내 오프셋
+                                    read_byte,              // 읽어야 할 바이트 수
+                                    segment_page_offset(seg, page->va)); // 파일 내 오프셋
+
+   // 이 페이지는 더 이상 uninit이 아니므로 구간 디스크립터 참조를 놓음
+   segment_put(seg);
 
    // lazy_loading에 필요한 read_byte와 실제로 필요한 read_byte가 다르면
-   if (my_read_byte != (off_t)lazy_info->readbyte)
+   if (my_read_byte != (off_t)read_byte)
    {
       return false;
    }
    // 읽은 데이터 뒤에 남는 영역을 0으로 초기화(제로 패딩)
-   memset(page->frame->kva + lazy_info->readbyte, 0, lazy_info->zerobyte);
-
-   // 동적 할당한 aux 구조체 메모리 해제
-   free(lazy_info);
+   memset(page->frame->kva + read_byte, 0, PGSIZE - read_byte);
    return true;
 }
 
@@ -864,43 +1001,38 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
    // 파일 오프셋도 페이지 단위 정렬되어 있어야 함
    ASSERT(ofs % PGSIZE == 0);
 
-   // 세그먼트 끝날 때까지
-   while (read_bytes > 0 || zero_bytes > 0)
-   {
-      /* 이 페이지를 어떻게 채울지 계산합니다.
-       * FILE에서 PAGE_READ_BYTES 바이트를 읽고
-       * 남은 PAGE_ZERO_BYTES 바이트는 0으로 초기화합니다. */
-      size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE; // 4KB까지만 읽어라
-      size_t page_zero_bytes = PGSIZE - page_read_bytes;                  // 0 패딩 사이즈는 4KB - read_byte
-
-      /* TODO: Set up aux to pass information to the lazy_load_segment. */
-      /* Lazy Loading을 위한 보조 정보(aux)를 준비
-         이 구조체는 실제 로딩 시 필요한 파일 정보 등을 포함
-      */
-      struct lazy_load_info *aux = malloc(sizeof(struct lazy_load_info)); // 전달해야할 인자
-      if (aux == NULL)
-         return false;
+   // 세그먼트 전체를 하나의 영역으로 등록 (다른 세그먼트와 겹치면 실패)
+   if (vma_insert(&thread_current()->spt.vmas, upage, upage + read_bytes + zero_bytes,
+                  VMA_SEGMENT, writable) == NULL)
+      return false;
 
-      // Lazy Loading을 위해 필요한 정보 저장
-      aux->file = file_reopen(file);         // 나중에 읽기 위해 파일 핸들 복사
-      aux->offset = ofs;                     // 파일에서 읽기 시작할 위치
-      aux->readbyte = page_read_bytes;       // 읽을 바이트 수
-      aux->zerobyte = page_zero_bytes;       // 0으로 채울 바이트 수
+   /* TODO: Set up aux to pass information to the lazy_load_segment. */
+   /* Lazy Loading을 위한 보조 정보(aux)를 세그먼트마다 하나 준비
+      모든 페이지가 이 디스크립터를 공유하며, 파일도 세그먼트당 한 번만 reopen
+   */
+   struct segment *seg = segment_create(file_reopen(file), upage, ofs, read_bytes);
+   if (seg == NULL)
+      return false;
 
-      if (!vm_alloc_page_with_initializer(VM_ANON,             // 페이지 타입은 익명 
-                                          upage,               // 가상 주소
+   // 세그먼트 끝날 때까지 (페이지별로 읽을 바이트 수는 lazy_load_segment가 계산)
+   bool success = true;
+   for (size_t i = 0; i < (read_bytes + zero_bytes) / PGSIZE; i++)
+   {
+      /* 읽기 전용 세그먼트(코드)는 같은 실행 파일을 돌리는 프로세스끼리 프레임을 공유합니다 */
+      if (!vm_alloc_page_with_initializer(writable ? VM_ANON : VM_TEXT, // 페이지 타입
+                                          upage + i * PGSIZE,  // 가상 주소
                                           writable,            // 쓰기 권한
                                           lazy_load_segment,   // 페이지 폴트 발생 시 호출될 함수
-                                          aux))                // Lazy_Loading_segment에 전달될 인자
-         return false;
-
-      /* Advance. */
-      read_bytes -= page_read_bytes;      // read_bytes 갱신
-      zero_bytes -= page_zero_bytes;      // zero_bytes 갱신
-      ofs += page_read_bytes;             // 파일 오프셋도 읽은 만큼 이동
-      upage += PGSIZE;                    // 가상 주소도 다음 페이지로 이동
+                                          segment_get(seg)))   // 페이지마다 디스크립터 참조 하나
+      {
+         segment_put(seg);
+         success = false;
+         break;
+      }
    }
-   return true;
+   // 만들면서 잡고 있던 참조를 놓음 (이제 페이지들만 참조)
+   segment_put(seg);
+   return success;
 }
 
 /* Create a PAGE of stack at the USER_STACK. Return true on success. */
@@ -913,6 +1045,10 @@ setup_stack(struct intr_frame *if_)
     * TODO: 성공했다면 rsp 값을 적절히 설정하세요.
     * TODO: 해당 페이지가 스택임을 표시해야 합니다. */
    /* TODO: Your code goes here */
+   /* 스택이 자랄 수 있는 범위 전체를 스택 영역으로 잡아 둡니다 */
+   if (vma_insert(&thread_current()->spt.vmas, (void *)(USER_STACK - STACK_MAX_SIZE),
+                  (void *)USER_STACK, VMA_STACK, true) == NULL)
+      return false;
    if (!vm_alloc_page(VM_ANON, stack_bottom, true))
       return false;
    if (!vm_claim_page(stack_bottom))
@@ -10,11 +10,14 @@
 #include "lib/kernel/console.h"
 #include "filesys/filesys.h"
 #include "userprog/process.h"
+#include "userprog/usercopy.h"
 #include "filesys/file.h"
 #include "threads/palloc.h"
+#include "threads/malloc.h"
 #include "threads/synch.h"
 #include "lib/user/syscall.h"
 #include "vm/vm.h"
+#include "vm/vmstat.h"
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
@@ -29,11 +32,17 @@ int sys_read(int fd, void *buffer, unsigned size);
 int find_unused_fd(const char *file);
 void sys_seek(int fd, unsigned position);
 unsigned sys_tell(int fd);
-void check_buffer(const void *buffer, unsigned size);
-void check_read_buffer(const void *buffer, unsigned size);
 int sys_wait(tid_t pid);
 int sys_dup2(int oldfd, int newfd);
 void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset);
+int sys_madvise(void *addr, size_t length, int advice);
+int sys_mincore(void *addr, size_t length, unsigned char *vec);
+void *sys_sbrk(intptr_t increment);
+int sys_msync(void *addr, size_t length);
+int sys_vmstat(struct vmstat *st);
+int sys_set_rss_limit(size_t pages);
+size_t sys_get_rss(void);
+tid_t sys_spawn(const char *cmd_line, const int *fd_map, size_t fd_cnt);
 
 /* 시스템 콜.
  *
@@ -135,110 +144,51 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_MUNMAP:
 		sys_munmap(arg1);
 		break;
+	case SYS_MADVISE:
+		f->R.rax = sys_madvise((void *)arg1, arg2, arg3);
+		break;
+	case SYS_MINCORE:
+		f->R.rax = sys_mincore((void *)arg1, arg2, (unsigned char *)arg3);
+		break;
+	case SYS_SBRK:
+		f->R.rax = (uint64_t)sys_sbrk((intptr_t)arg1);
+		break;
+	case SYS_MSYNC:
+		f->R.rax = sys_msync((void *)arg1, arg2);
+		break;
+	case SYS_VMSTAT:
+		f->R.rax = sys_vmstat((struct vmstat *)arg1);
+		break;
+	case SYS_SET_RSS_LIMIT:
+		f->R.rax = sys_set_rss_limit(arg1);
+		break;
+	case SYS_GET_RSS:
+		f->R.rax = sys_get_rss();
+		break;
+	case SYS_SPAWN:
+		f->R.rax = sys_spawn((const char *)arg1, (const int *)arg2, arg3);
+		break;
 	default:
 		thread_exit();
 		break;
 	}
 }
 
-// 주소값이 유저 영역(0x8048000~0xc0000000)에서 사용하는 주소값인지 확인하는 함수
-void check_address(const uint64_t *addr)
-{
-	struct thread *cur = thread_current();
-
-	if (addr == "" || !(is_user_vaddr(addr)) || pml4_get_page(cur->pml4, addr) == NULL)
-	{
-		sys_exit(-1);
-	}
-}
-
-// writeable 관련 오류가 뜰... sudo?
-void check_buffer(const void *buffer, unsigned size)
-{
-	// 예외 처리
-	if (buffer == NULL)
-	{
-		sys_exit(-1);
-	}
-
-	uint8_t *start = (uint8_t *)pg_round_down(buffer);
-	uint8_t *end = (uint8_t *)pg_round_down(buffer + size - 1);
-	struct thread *cur = thread_current();
-
-	for (uint8_t *addr = start; addr <= end; addr += PGSIZE)
-	{
-		if (!is_user_vaddr(addr))
-		{
-			// printf("Invalid page address: %p\n", addr);
-			sys_exit(-1);
-		}
-
-		// if (pml4_get_page(cur->pml4, addr) == NULL){
-		// 	if (vm_try_handle_fault(NULL, addr, true, writeable, true) == false)
-		// 		sys_exit(-1);
-		// }
-		// else{
-		// 	if(writeable && !is_writable(pml4e_walk(cur->pml4, (uint64_t)addr, 0)))
-		// 		sys_exit(-1);
-		// }
-
-		if (pml4_get_page(cur->pml4, addr) == NULL)
-		{
-			if (!vm_try_handle_fault(NULL, addr, true, false, true))
-				sys_exit(-1);
-		}
-	}
-}
-
-void check_read_buffer(const void *buffer, unsigned size)
+/* 사용자 문자열 UNAME(파일 이름)을 새 커널 페이지에 복사해 반환합니다. 호출한 쪽이 해제합니다.
+ * 복사 중 폴트(지연 로딩)가 filesys_lock을 잡을 수 있으므로 락을 잡기 전에 복사해야 하며,
+ * 접근할 수 없는 주소이면 프로세스를 종료합니다. */
+static char *
+copy_user_name(const char *uname)
 {
-	if (is_user_vaddr(buffer) == false || is_user_vaddr(buffer + size - 1) == false)
-	{
+	char *name = palloc_get_page(0);
+	if (name == NULL)
 		sys_exit(-1);
-	}
-	check_buffer(buffer, size);
-}
-
-void check_write_buffer(const void *buffer, unsigned size)
-{
-	if (is_user_vaddr(buffer) == false || is_user_vaddr(buffer + size - 1) == false)
+	if (strncpy_from_user(name, uname, PGSIZE) < 0)
 	{
+		palloc_free_page(name);
 		sys_exit(-1);
 	}
-	check_buffer(buffer, size);
-
-	uint8_t *start = (uint8_t *)pg_round_down(buffer);
-	uint8_t *end = (uint8_t *)pg_round_down(buffer + size - 1);
-	struct thread *cur = thread_current();
-
-	for (uint8_t *addr = start; addr <= end; addr += PGSIZE)
-	{
-		if (!is_user_vaddr(addr))
-			sys_exit(-1);
-
-		void *page = pml4_get_page(cur->pml4, addr);
-		if (page == NULL)
-		{
-			// 여기서는 writeable=true로 fault 처리 시도
-			if (!vm_try_handle_fault(NULL, addr, true, true, true))
-				sys_exit(-1);
-		}
-		else
-		{
-			// 이미 매핑되어 있다면 write 권한 확인
-			uint64_t *pte = pml4e_walk(cur->pml4, (uint64_t)addr, false);
-			struct page *cur_page = spt_find_page(&cur->spt, addr);
-			bool page_writable = cur_page->writable;
-			if (pte == NULL || (!is_writable(pte) && !page_writable))
-			{
-				sys_exit(-1); // 쓰기 권한이 없으면 종료
-			}
-			else if (pte == NULL || (!is_writable(pte) && page_writable))
-			{
-				vm_try_handle_fault(NULL, addr, true, true, true);
-			}
-		}
-	}
+	return name;
 }
 
 /* addr은 mmap으로 할당받은 시작주소 */
@@ -257,6 +207,14 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	/* 	fd = 파일 디스크립터 번호
 		fd = 0 (stdin), 1(stdout)으로 이미 예약되어 있어 mmap에 사용 X
 	*/
+	/* 익명 매핑: 파일 없이 0으로 채워지는 영역을 만듭니다 */
+	if (fd == MAP_ANONYMOUS)
+	{
+		if (length == 0 || addr == NULL || pg_ofs(addr) != 0 || offset != 0 || !is_user_vaddr(addr))
+			return MAP_FAILED;
+		return do_mmap(addr, length, writable, NULL, 0);
+	}
+
 	if (fd < 2)
 		return MAP_FAILED;
 
@@ -286,35 +244,24 @@ void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	if (target_file == NULL)
 		return MAP_FAILED;
 
-	/* 매핑할 시작 주소 저장 */
-	void *start_page = addr;
-	/* 매핑할 끝 주소 (addr + length)를 페이지 크기로 올림 처리 */
-	void *end_page = pg_round_up(addr + length);
-
-	/* 해당 페이지 영역에 이미 할당된 페이지가 있으면 mmap이 불가능 합니다 */
-	for (; end_page > start_page; start_page += PGSIZE)
-	{
-		if (spt_find_page(&thread_current()->spt, start_page) != NULL)
-			return MAP_FAILED;
-	}
-
-	/* 실제 mmap을 수행하는 내부 함수 호출*/
-	do_mmap(addr, length, writable, target_file, offset);
-
-	return addr;
+	/*	실제 mmap을 수행하는 내부 함수 호출
+		기존 영역(코드, 데이터, 스택, 다른 mmap)과 겹치면 실패(NULL = MAP_FAILED)합니다
+	*/
+	return do_mmap(addr, length, writable, target_file, offset);
 }
 
 int sys_exec(char *file_name)
 {
-	check_address(file_name);
-
-	int size = strlen(file_name) + 1;
 	char *fn_copy = palloc_get_page(PAL_ZERO);
 	if ((fn_copy) == NULL)
 	{
 		sys_exit(-1);
 	}
-	strlcpy(fn_copy, file_name, size);
+	if (strncpy_from_user(fn_copy, file_name, PGSIZE) < 0)
+	{
+		palloc_free_page(fn_copy);
+		sys_exit(-1);
+	}
 
 	if (process_exec(fn_copy) == -1)
 	{
@@ -325,6 +272,112 @@ int sys_exec(char *file_name)
 	return 0;
 }
 
+/* MADV_* 값은 enum vm_advice와 같은 순서이므로 범위만 확인하고 그대로 넘깁니다. */
+int sys_madvise(void *addr, size_t length, int advice)
+{
+	if (advice < MADV_NORMAL || advice > MADV_DONTNEED)
+		return -1;
+	return vm_madvise(addr, length, (enum vm_advice)advice) ? 0 : -1;
+}
+
+/* 결과는 커널 버퍼에 한 페이지 분량(PGSIZE개 페이지)씩 모아 사용자 VEC으로 복사합니다. */
+int sys_mincore(void *addr, size_t length, unsigned char *vec)
+{
+	size_t cnt = (length + PGSIZE - 1) / PGSIZE;
+
+	if (pg_ofs(addr) != 0)
+		return -1;
+	if (cnt == 0)
+		return vm_mincore(addr, length, vec) ? 0 : -1;
+
+	unsigned char *kvec = palloc_get_page(0);
+	if (kvec == NULL)
+		return -1;
+	int result = 0;
+	for (size_t done = 0; done < cnt && result == 0; done += PGSIZE)
+	{
+		size_t n = cnt - done < PGSIZE ? cnt - done : PGSIZE;
+		if (!vm_mincore((uint8_t *)addr + done * PGSIZE, n * PGSIZE, kvec))
+			result = -1;
+		else if (!copy_to_user(vec + done, kvec, n))
+		{
+			palloc_free_page(kvec);
+			sys_exit(-1);
+		}
+	}
+	palloc_free_page(kvec);
+	return result;
+}
+
+void *sys_sbrk(intptr_t increment)
+{
+	return vm_sbrk(increment);
+}
+
+int sys_msync(void *addr, size_t length)
+{
+	return vm_msync(addr, length) ? 0 : -1;
+}
+
+int sys_vmstat(struct vmstat *st)
+{
+	struct vmstat *kst = malloc(sizeof *kst);
+	if (kst == NULL)
+		return -1;
+	vmstat_get(kst);
+	bool ok = copy_to_user(st, kst, sizeof *kst);
+	free(kst);
+	if (!ok)
+		sys_exit(-1);
+	return 0;
+}
+
+int sys_set_rss_limit(size_t pages)
+{
+	vm_set_rss_limit(pages);
+	return 0;
+}
+
+size_t sys_get_rss(void)
+{
+	return vm_get_rss();
+}
+
+/* cmd_line의 프로그램을 새 자식 프로세스로 바로 시작합니다.
+ * 명령줄과 fd 대응표를 커널로 복사해 process_spawn에 넘깁니다. */
+tid_t sys_spawn(const char *cmd_line, const int *fd_map, size_t fd_cnt)
+{
+	char *cmd_copy = palloc_get_page(PAL_ZERO);
+	if (cmd_copy == NULL)
+		return TID_ERROR;
+	if (strncpy_from_user(cmd_copy, cmd_line, PGSIZE) < 0)
+	{
+		palloc_free_page(cmd_copy);
+		sys_exit(-1);
+	}
+
+	int *map = NULL;
+	if (fd_map != NULL)
+	{
+		/* fd_cnt가 0이어도 NULL(모두 물려줌)과 구별되도록 한 칸은 잡습니다 */
+		if (fd_cnt > MAX_FD || (map = malloc((fd_cnt > 0 ? fd_cnt : 1) * sizeof *map)) == NULL)
+		{
+			palloc_free_page(cmd_copy);
+			return TID_ERROR;
+		}
+		if (!copy_from_user(map, fd_map, fd_cnt * sizeof *map))
+		{
+			free(map);
+			palloc_free_page(cmd_copy);
+			sys_exit(-1);
+		}
+	}
+
+	tid_t tid = process_spawn(cmd_copy, map, fd_cnt);
+	free(map);
+	return tid;
+}
+
 struct file *
 process_get_file(int fd)
 {
@@ -341,27 +394,49 @@ void sys_halt()
 	power_off();
 }
 
+/* 사용자 버퍼는 페이지 단위로 커널 버퍼에 복사한 뒤 씁니다.
+ * 복사 중 폴트(지연 로딩)가 filesys_lock을 잡을 수 있으므로 락 밖에서 복사합니다. */
 static int sys_write(int fd, const void *buffer, unsigned size)
 {
-	check_read_buffer(buffer, size);
 	// fd가 유효한지 먼저 검사
 	if (fd < 0 || fd >= MAX_FD)
 		return -1;
 
 	struct thread *cur = thread_current();
+	bool console = cur->fd_table[fd] == STDOUT && cur->stdout_count != 0;
+	struct file *f = NULL;
+	if (!console && (f = process_get_file(fd)) == NULL)
+		return -1;
+	if (size == 0)
+		return 0;
 
-	if (cur->fd_table[fd] == STDOUT && cur->stdout_count != 0)
+	char *kbuf = palloc_get_page(0);
+	if (kbuf == NULL)
+		return -1;
+	unsigned bytes_written = 0;
+	while (bytes_written < size)
 	{
-		putbuf(buffer, size);
-		return size;
+		unsigned chunk = size - bytes_written < PGSIZE ? size - bytes_written : PGSIZE;
+		if (!copy_from_user(kbuf, (const uint8_t *)buffer + bytes_written, chunk))
+		{
+			palloc_free_page(kbuf);
+			sys_exit(-1);
+		}
+		if (console)
+		{
+			putbuf(kbuf, chunk);
+			bytes_written += chunk;
+			continue;
+		}
+		lock_acquire(&filesys_lock);
+		int n = file_write(f, kbuf, chunk);
+		lock_release(&filesys_lock);
+		if (n > 0)
+			bytes_written += n;
+		if (n < (int)chunk)
+			break;
 	}
-	struct file *f = process_get_file(fd);
-	if (f == NULL)
-		return -1;
-
-	lock_acquire(&filesys_lock);
-	int bytes_written = file_write(f, buffer, size);
-	lock_release(&filesys_lock);
+	palloc_free_page(kbuf);
 	return bytes_written;
 }
 
@@ -376,24 +451,27 @@ void sys_exit(int status)
 
 bool sys_create(const char *file, unsigned initial_size)
 {
-	lock_acquire(&filesys_lock);
-	check_address(file);
-	if (file == NULL || strcmp(file, "") == 0)
+	char *name = copy_user_name(file);
+	if (name[0] == '\0')
 	{
+		palloc_free_page(name);
 		sys_exit(-1);
 	}
 
-	bool success = filesys_create(file, initial_size);
+	lock_acquire(&filesys_lock);
+	bool success = filesys_create(name, initial_size);
 	lock_release(&filesys_lock);
+	palloc_free_page(name);
 	return success;
 }
 
 bool sys_remove(const char *file)
 {
-	check_address(file);
+	char *name = copy_user_name(file);
 	lock_acquire(&filesys_lock);
-	bool success = filesys_remove(file);
+	bool success = filesys_remove(name);
 	lock_release(&filesys_lock);
+	palloc_free_page(name);
 	return success;
 }
 
@@ -419,14 +497,14 @@ int sys_filesize(int fd)
 	return size;
 }
 
+/* 페이지 단위로 커널 버퍼에 읽은 뒤 사용자 버퍼로 복사합니다.
+ * 복사 중 폴트가 filesys_lock을 잡을 수 있으므로 락을 놓은 뒤 복사합니다. */
 int sys_read(int fd, void *buffer, unsigned size)
 {
 
 	if (size == 0)
 		return 0;
 
-	check_write_buffer(buffer, size); // 페이지 단위 검사
-
 	struct thread *cur = thread_current();
 
 	if (fd < 0 || fd >= MAX_FD)
@@ -434,31 +512,44 @@ int sys_read(int fd, void *buffer, unsigned size)
 		return -1;
 	}
 
-	// stdin 처리
-	if (cur->fd_table[fd] == STDIN)
-	{
-		if (cur->stdin_count != 0)
-		{
-			for (unsigned i = 0; i < size; i++)
-			{
-				((char *)buffer)[i] = input_getc();
-			}
-			return size;
-		}
-		return -1;
-	}
-
 	struct file *file_obj = cur->fd_table[fd];
+	bool console = file_obj == STDIN;
 
-	if (file_obj == NULL || file_obj == STDIN || file_obj == STDOUT)
+	if (console ? cur->stdin_count == 0 : file_obj == NULL || file_obj == STDOUT)
 	{
 		return -1;
 	}
 
-	// 파일 읽기
-	lock_acquire(&filesys_lock);
-	int bytes_read = file_read(file_obj, buffer, size);
-	lock_release(&filesys_lock);
+	char *kbuf = palloc_get_page(0);
+	if (kbuf == NULL)
+		return -1;
+	unsigned bytes_read = 0;
+	while (bytes_read < size)
+	{
+		unsigned chunk = size - bytes_read < PGSIZE ? size - bytes_read : PGSIZE;
+		int n = chunk;
+		// stdin 처리
+		if (console)
+			for (unsigned i = 0; i < chunk; i++)
+				kbuf[i] = input_getc();
+		else
+		{
+			// 파일 읽기
+			lock_acquire(&filesys_lock);
+			n = file_read(file_obj, kbuf, chunk);
+			lock_release(&filesys_lock);
+		}
+		if (n > 0 && !copy_to_user((uint8_t *)buffer + bytes_read, kbuf, n))
+		{
+			palloc_free_page(kbuf);
+			sys_exit(-1);
+		}
+		if (n > 0)
+			bytes_read += n;
+		if (n < (int)chunk)
+			break;
+	}
+	palloc_free_page(kbuf);
 	return bytes_read;
 }
 
@@ -479,13 +570,15 @@ int find_unused_fd(const char *file)
 
 int sys_open(const char *file)
 {
-	check_address(file);
-	if (file == NULL || strcmp(file, "") == 0)
+	char *name = copy_user_name(file);
+	if (name[0] == '\0')
 	{
+		palloc_free_page(name);
 		return -1;
 	}
 	lock_acquire(&filesys_lock);
-	struct file *file_obj = filesys_open(file);
+	struct file *file_obj = filesys_open(name);
+	palloc_free_page(name);
 	if (file_obj == NULL)
 	{
 		lock_release(&filesys_lock);
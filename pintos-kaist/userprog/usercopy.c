@@ -0,0 +1,68 @@
+#include "userprog/usercopy.h"
+#include <debug.h>
+#include "threads/vaddr.h"
+
+/* copy-user.S의 기본 연산 */
+size_t __copy_user(void *dst, const void *src, size_t n);
+long __strncpy_user(char *dst, const char *src, size_t n);
+
+/* 예외 테이블 엔트리: INSN에서 난 폴트는 FIXUP에서 이어 갑니다. */
+struct ex_entry
+{
+	uintptr_t insn;
+	uintptr_t fixup;
+};
+
+/* 링커 스크립트가 __ex_table 섹션의 시작과 끝에 둡니다. */
+extern const struct ex_entry _start_ex_table[], _end_ex_table[];
+
+/* [UADDR, UADDR + SIZE)가 통째로 사용자 영역 안에 있으면 true.
+ * 페이지가 실제로 있는지는 보지 않습니다. 없으면 복사 중 폴트로 드러납니다. */
+static bool
+user_range_ok(const void *uaddr, size_t size)
+{
+	uintptr_t start = (uintptr_t)uaddr;
+	return start + size >= start && start + size <= KERN_BASE;
+}
+
+/* 사용자 주소 USRC에서 SIZE 바이트를 DST로 복사합니다. 범위 중 접근할 수 없는
+ * 곳이 있으면 false를 반환하며, 그때 DST에는 앞부분만 복사되어 있을 수 있습니다. */
+bool copy_from_user(void *dst, const void *usrc, size_t size)
+{
+	return user_range_ok(usrc, size) && __copy_user(dst, usrc, size) == 0;
+}
+
+/* SRC의 SIZE 바이트를 사용자 주소 UDST로 복사합니다. 범위 중 쓸 수 없는
+ * 곳이 있으면 false를 반환하며, 그때 앞부분만 기록되어 있을 수 있습니다. */
+bool copy_to_user(void *udst, const void *src, size_t size)
+{
+	return user_range_ok(udst, size) && __copy_user(udst, src, size) == 0;
+}
+
+/* 사용자 주소 USRC의 문자열을 널 문자까지 DST(SIZE 바이트)로 복사하고 길이를 반환합니다.
+ * 문자열에 접근할 수 없거나 SIZE 바이트 안에 끝나지 않으면 -1을 반환합니다. */
+int strncpy_from_user(char *dst, const char *usrc, size_t size)
+{
+	uintptr_t start = (uintptr_t)usrc;
+	long len;
+
+	if (start >= KERN_BASE || size == 0)
+		return -1;
+	/* 커널 영역으로 넘어가 읽지 않도록 사용자 영역 끝에서 멈춥니다 */
+	if (size > KERN_BASE - start)
+		size = KERN_BASE - start;
+	len = __strncpy_user(dst, usrc, size);
+	if (len < 0 || (size_t)len >= size)
+		return -1;
+	return len;
+}
+
+/* 커널 모드 페이지 폴트가 난 명령 주소 RIP가 예외 테이블에 있으면 복구 주소를,
+ * 없으면 0을 반환합니다. */
+uintptr_t usercopy_fixup(uintptr_t rip)
+{
+	for (const struct ex_entry *e = _start_ex_table; e < _end_ex_table; e++)
+		if (e->insn == rip)
+			return e->fixup;
+	return 0;
+}
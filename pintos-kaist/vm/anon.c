@@ -2,17 +2,29 @@
 
 #include "vm/vm.h"
 #include "threads/vaddr.h"
-#include "lib/kernel/bitmap.h"
 #include "devices/disk.h"
 #include "threads/mmu.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
+#include <stdio.h>
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
 static bool anon_swap_in(struct page *page, void *kva);
 static bool anon_swap_out(struct page *page);
 static void anon_destroy(struct page *page);
+static void anon_swap_keep(struct page *page);
 
-struct bitmap *swap_table;
+/* 한 페이지(스왑 슬롯)를 구성하는 섹터 수 */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
+/* 통계 */
+static long long swap_out_pages; /* 내보낸 페이지 수 */
+static long long swap_out_ios;	 /* 내보내기에 사용한 디스크 명령 묶음 수 */
+static long long swap_in_pages;	 /* 읽어 들인 페이지 수 (readahead 포함) */
+static long long swap_in_ios;	 /* 읽기에 사용한 디스크 명령 묶음 수 */
+static long long readahead_pages; /* 폴트 없이 미리 읽은 페이지 수 */
+static long long swap_kept_pages; /* swap-in 한 뒤에도 슬롯을 남겨 둔 페이지 수 */
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
@@ -36,19 +48,17 @@ void vm_anon_init(void)
 		PANIC("CAN'T FIND SWAP DISK!");
 	}
 
-	/** TODO: bitmap 자료구조로 스왑 테이블 만들기
-		스왑 테이블은 각 스왑 슬록(swap slot)의 사용 여부를 추적하기 위한 비트맵
+	/*	스왑 슬롯 할당기 초기화
 		- 스왑 슬롯 : 메모리의 한 페이지를 디스크에 저장할 수 있는 최소 단위(1 page = PGSIZE)
 		- 각 스왑 슬롯은 여러 개의 디스크 섹터(sector)로 구성
 
 		따라서 스왑 슬롯의 개수 = 전체 디스크 섹터 수 / 한 페이지를 구성하는 섹터 수
-		- 디스크 전체 섹터 수 : disk_size(swap_disk)
-		- 한 페이지당 섹터 수 : PGSIZE / DISK_SECTOR_SIZE
-
-		이 값을 기반으로 비트맵을 생성
-		- bitmap의 각 비트는 하나의 스왑 슬롯을 의미하며, 0이면 비어있고 1이면 사용중
+		빈 슬롯은 swap.c가 연속 구간 단위로 관리합니다
 	 */
-	swap_table = bitmap_create(disk_size(swap_disk) / (PGSIZE / DISK_SECTOR_SIZE));
+	swap_init(disk_size(swap_disk) / SECTORS_PER_SLOT);
+
+	// "-zswap=PAGES" 옵션이 주어졌으면 스왑 디스크 앞단의 압축 메모리 영역도 준비
+	zswap_init();
 }
 
 /* Initialize the file mapping */
@@ -72,12 +82,12 @@ bool anon_initializer(struct page *page, enum vm_type type, void *kva)
 		-1은 아직 스왑 아웃된 적이 없다는 것을 의미
 	*/
 	anon_page->swap_idx = -1;
+	anon_page->zswap = NULL;
 
-	/*	페이지의 물리 주소(kva)가 유효하며,
-		해당 페이지의 frame이 1개 이하로만 참조되고 있을 경우
-		새로 할당된 물리 페이지라고 간주하고 초기화함
+	/*	kva가 주어지면 새로 할당된 물리 페이지이므로 초기화함
+		fork에서 부모의 프레임이나 스왑 슬롯을 물려받는 페이지는 kva 없이 초기화됨
 	*/
-	if (kva != NULL && page->frame->ref_cnt <= 1)
+	if (kva != NULL)
 	{
 		// 물리 페이지 전체를 0으로 초기화(보안 및 예측 가능한 동작 보장)
 		memset(kva, 0, PGSIZE);
@@ -91,6 +101,13 @@ static bool
 anon_swap_in(struct page *page, void *kva)
 {
 	struct anon_page *anon_page = &page->anon;
+
+	// 압축 스왑 영역에 있으면 디스크 I/O 없이 압축만 풀면 됨
+	if (zswap_load(page, kva))
+	{
+		return true;
+	}
+
 	int swap_idx = anon_page->swap_idx;
 
 	// 예외 처리 → swap_idx가 -1이면 페이지가 스왑아웃된 적이 없거나 이미 복구되었으므로 스왑 인 생략
@@ -98,35 +115,48 @@ anon_swap_in(struct page *page, void *kva)
 	{
 		return false;
 	}
-	// disk_read에서 사용할 버퍼
-	// void *buffer[PGSIZE];
-	/** TODO: 페이지 스왑 인
-	 * disk_read를 데이터를 읽고 kva에 데이터 복사
-	 * swap_idx를 -1로 바꿔주어야 함
-	 * 프레임 테이블에 해당 프레임 넣어주기
-	 * 프레임하고 페이지 매핑해주기
-	 */
 
 	// 한 섹터는 512바이트이고, 한 페이지는 4KB(4096바이트)이므로
-	// 총 8개의 섹터를 순차적으로 읽어야 전체 페이지 데이터를 복원할 수 있음
-	// swap_idx는 스왑 테이블 상의 페이지 단위 인덱스를 의미하며,
-	// 실제 섹터 번호는 swap_idx * 8부터 시작함
-	for (int i = 0; i < 8; i++)
-	{
-		disk_read(swap_disk,					 // 스왑 디스크에서 데이터를 읽어옴
-				  (swap_idx * 8) + i,			 // 8개의 연속된 섹터에 페이지가 저장되어 있으므로, i를 더해가며 읽음
-				  kva + (DISK_SECTOR_SIZE * i)); // 읽어온 데이터를 커널 가상 주소 kva에 512B 단위로 복사
-	}
+	// 슬롯 하나는 연속된 8개의 섹터이며, 실제 섹터 번호는 swap_idx * 8부터 시작함
+	// 8개의 섹터를 한 번의 디스크 명령으로 kva에 읽어 들임
+	disk_read_multiple(swap_disk, swap_idx * SECTORS_PER_SLOT, &kva, 1, SECTORS_PER_SLOT);
+	swap_in_pages++;
+	swap_in_ios++;
 
-	// 스왑 테이블에서 해당 스왑 슬롯을 비어있다고 표시 (해당 슬롯 재사용 가능하도록)
-	bitmap_reset(swap_table, swap_idx);
-
-	// 페이지가 더 이상 스왑 영역에 존재하지 않음을 나타내기 위해 swap_idx를 -1로 초기화
-	anon_page->swap_idx = -1;
+	// 슬롯의 사본은 페이지에 쓰기 전까지 유효하므로 남겨 두어, 교체될 때 다시 기록하지 않게 함
+	// 스왑이 반 이상 차 있으면 슬롯을 비어있다고 표시하고 swap_idx를 -1로 초기화
+	anon_swap_keep(page);
 
 	return true;
 }
 
+/* 스왑 슬롯이 연속된 PAGES[0..CNT)를 한 번의 디스크 명령으로 읽어 들입니다.
+ * PAGES[i]의 슬롯은 PAGES[0]의 슬롯 + i 이어야 하고, 각 페이지는 이미
+ * (pinned 상태의) 프레임에 매핑되어 있어야 합니다. 첫 페이지를 제외한 나머지는
+ * readahead로 집계합니다. */
+void
+anon_swap_in_cluster(struct page *pages[], size_t cnt)
+{
+	void *bufs[SWAP_CLUSTER];
+	int base = pages[0]->anon.swap_idx;
+
+	ASSERT(cnt > 0 && cnt <= SWAP_CLUSTER);
+	ASSERT(base >= 0);
+
+	for (size_t i = 0; i < cnt; i++)
+	{
+		ASSERT(pages[i]->anon.swap_idx == base + (int)i);
+		bufs[i] = pages[i]->frame->kva;
+	}
+	disk_read_multiple(swap_disk, base * SECTORS_PER_SLOT, bufs, cnt, SECTORS_PER_SLOT);
+
+	for (size_t i = 0; i < cnt; i++)
+		anon_swap_keep(pages[i]);
+	swap_in_pages += cnt;
+	swap_in_ios++;
+	readahead_pages += cnt - 1;
+}
+
 /* 페이지의 내용을 스왑 디스크에 기록하여 스왑아웃합니다. */
 static bool
 anon_swap_out(struct page *page)
@@ -136,38 +166,146 @@ anon_swap_out(struct page *page)
 	{
 		return false;
 	}
-	struct anon_page *anon_page = &page->anon;
-	/** TODO: disk_write를 사용하여 disk에 기록
-	 * 섹터 크기는 512바이트라 8번 반복해야합니다
-	 * 비어있는 스왑 슬롯을 스왑 테이블에서 검색
-	 * 검색된 스왑 슬롯 인덱스를 anon_page에 저장
-	 * disk_write를 통해 해당 디스크 섹터에 저장
-	 */
 
-	size_t swap_idx = bitmap_scan_and_flip(swap_table, 0, 1, false);
+	// 빈 스왑 슬롯을 찾아 한 번의 디스크 명령으로 8개 섹터를 기록하고
+	// 슬롯 인덱스를 anon_page에 저장해 나중에 다시 swap_in할 수 있게 함
+	return anon_swap_out_cluster(&page, 1);
+}
 
-	if (swap_idx == BITMAP_ERROR)
+/* PAGES[0..CNT)를 내보냅니다.
+ * 압축 스왑 영역이 켜져 있으면 먼저 압축해서 메모리에 보관하고,
+ * 압축이 잘 되지 않거나 자리가 없는 페이지만 스왑 디스크에 기록합니다.
+ * 디스크에 기록할 때는 가능하면 연속된 슬롯을 한 번에 잡아 하나의 디스크 명령으로 기록하고,
+ * 연속된 빈 슬롯이 없으면 페이지마다 따로 슬롯을 잡습니다.
+ * 호출자는 주소 순서로 정렬해 넘겨서 이웃한 페이지가 이웃한 슬롯에 놓이게 합니다
+ * (swap-in 시 readahead가 가능해집니다).
+ * 슬롯이 모자라 일부를 기록하지 못했다면 false를 반환하며,
+ * 그 페이지들의 swap_idx는 -1로 남습니다. */
+bool
+anon_swap_out_cluster(struct page *pages[], size_t cnt)
+{
+	struct page *disk_pages[SWAP_CLUSTER];
+	const void *bufs[SWAP_CLUSTER];
+	size_t disk_cnt = 0;
+	bool success = true;
+
+	ASSERT(cnt > 0 && cnt <= SWAP_CLUSTER);
+
+	for (size_t i = 0; i < cnt; i++)
+		if (!zswap_store(pages[i], pages[i]->frame->kva))
+			disk_pages[disk_cnt++] = pages[i];
+	if (disk_cnt == 0)
+		return true;
+	pages = disk_pages;
+	cnt = disk_cnt;
+
+	size_t base = swap_alloc(cnt);
+	if (base != SWAP_ERROR)
 	{
-		ASSERT(bitmap_test(swap_table, swap_idx) == false);
-		return false;
+		for (size_t i = 0; i < cnt; i++)
+		{
+			bufs[i] = pages[i]->frame->kva;
+			pages[i]->anon.swap_idx = base + i;
+		}
+		disk_write_multiple(swap_disk, base * SECTORS_PER_SLOT, bufs, cnt, SECTORS_PER_SLOT);
+		swap_out_pages += cnt;
+		swap_out_ios++;
+		return true;
 	}
 
-	// swap in에 자세히 주석을 달아 놓았음 잘 살펴 보셈
-	for (int i = 0; i < 8; i++)
-	{
-		disk_write(swap_disk, (swap_idx * 8) + i, page->frame->kva + (DISK_SECTOR_SIZE * i));
-	}
+	// 연속된 자리가 없으면 한 장씩 흩어서 기록
+	for (size_t i = 0; i < cnt; i++)
+		if (!anon_writeback(pages[i], pages[i]->frame->kva))
+			success = false;
+	return success;
+}
 
-	// 페이지와 프레임 간의 연결을 끊음 (프레임은 더 이상 이 페이지를 참조 하지 않음)
-	page->frame->page = NULL;
-	page->frame = NULL;
+/* BUF에 있는 PAGE의 내용을 빈 스왑 슬롯 하나에 기록하고 swap_idx를 정합니다.
+ * 빈 슬롯이 없으면 false를 반환합니다. */
+bool
+anon_writeback(struct page *page, const void *buf)
+{
+	size_t swap_idx = swap_alloc(1);
 
-	// 스왑 슬록 인덱스를 anon_page에 저장해 나중에 다시 swap_in할 수 있게 함
-	anon_page->swap_idx = swap_idx;
+	if (swap_idx == SWAP_ERROR)
+		return false;
+	disk_write_multiple(swap_disk, swap_idx * SECTORS_PER_SLOT, &buf, 1, SECTORS_PER_SLOT);
+	page->anon.swap_idx = swap_idx;
+	swap_out_pages++;
+	swap_out_ios++;
+	return true;
+}
 
+/* 스왑된 페이지 SRC의 내용을 DST도 복사 없이 가리키게 합니다.
+ * zswap 항목은 압축된 채로 한 벌 더 두고, 스왑 슬롯은 참조 수만 늘려 함께 씁니다.
+ * fork와, 프레임을 공유하던 페이지들을 한꺼번에 내보낼 때 씁니다.
+ * DST를 스왑된 상태로 만들지 못하면 false를 반환합니다. */
+bool
+anon_swap_share(struct page *dst, struct page *src)
+{
+	dst->anon.swap_idx = -1;
+	dst->anon.zswap = NULL;
+
+	/* zswap의 writeback은 swap_idx를 정한 뒤 항목을 지우므로,
+	 * 항목이 없다면 swap_idx는 이미 유효합니다 */
+	if (zswap_dup(dst, src))
+		return anon_is_swapped(dst);
+	if (src->anon.swap_idx < 0)
+		return false;
+	swap_share(src->anon.swap_idx);
+	dst->anon.swap_idx = src->anon.swap_idx;
 	return true;
 }
 
+/* PAGE의 내용이 스왑 디스크나 압축 스왑 영역에 보관되어 있으면 true를 반환합니다.
+ * 프레임에 올라와 있는 페이지는 남겨 둔 슬롯이 있어도 true 이므로, 슬롯이 유효한지는
+ * 호출자가 dirty 비트로 판단해야 합니다. */
+bool
+anon_is_swapped(struct page *page)
+{
+	return page->anon.swap_idx >= 0 || page->anon.zswap != NULL;
+}
+
+/* PAGE가 점유하고 있는 압축 스왑 항목과 스왑 슬롯을 반환하고 swap_idx를 -1로 만듭니다.
+ * zswap의 writeback이 swap_idx를 정한 뒤에 항목을 지우므로 항목을 먼저 정리합니다. */
+void
+anon_swap_release(struct page *page)
+{
+	struct anon_page *anon_page = &page->anon;
+
+	zswap_invalidate(page);
+	if (anon_page->swap_idx < 0)
+		return;
+	swap_free(anon_page->swap_idx, 1);
+	anon_page->swap_idx = -1;
+}
+
+/* 방금 swap-in 한 PAGE의 스왑 슬롯을 남겨 둘지 정합니다.
+ * 남겨 둔 슬롯은 PTE의 dirty 비트가 꺼져 있는 동안 프레임과 같은 내용을 담고 있으므로
+ * 교체할 때 기록 없이 프레임을 비울 수 있습니다. 스왑이 반 이상 차 있으면 돌려줍니다. */
+static void
+anon_swap_keep(struct page *page)
+{
+	if (page->anon.swap_idx < 0)
+		return;
+	if (swap_full())
+		anon_swap_release(page);
+	else
+		swap_kept_pages++;
+}
+
+/* 스왑 통계를 출력합니다. */
+void
+anon_print_stats(void)
+{
+	printf("Swap: %lld pages out in %lld writes, %lld pages in in %lld reads "
+		   "(%lld readahead, %lld kept slots)\n",
+		   swap_out_pages, swap_out_ios, swap_in_pages, swap_in_ios,
+		   readahead_pages, swap_kept_pages);
+	swap_print_stats();
+	zswap_print_stats(swap_in_pages);
+}
+
 /* 
  * anon_destroy - 익명(anonymous) 페이지를 소멸시킵니다.
  * 
@@ -180,20 +318,9 @@ anon_swap_out(struct page *page)
 static void
 anon_destroy(struct page *page)
 {
-	// 페이지의 anon_page 구조체 접근 (swap 관련 정보 포함)
-	struct anon_page *anon_page = &page->anon;
-
-	// 현재 스레드의 pml4에서 이 페이지에 대한 매핑을 제거 (VA -> PA 연결 해제)
-	pml4_clear_page(thread_current()->pml4, page->va);
-
-	// 스왑 아웃된 적이 없거나, 이미 스왑에서 복구되어 유효하지 않은 스왑 슬롯이면 아무 작업도 하지 않음
-	// swap_idx < 0이면 해당 페이지는 스왑 슬롯을 점유하고 있지 않음
-	if (anon_page->swap_idx < 0)
-	{
-		return;  // 추가 작업 없이 종료
-	}
+	// VA -> PA 매핑 해제는 vm_dealloc_page가 역매핑을 통해 처리합니다
 
-	// 스왑 테이블에서 해당 스왑 슬롯을 비어있는 상태로 표시
-	// 즉, 해당 슬롯은 이제 다른 페이지가 사용 가능하도록 반환됨
-	bitmap_reset(swap_table, anon_page->swap_idx);
+	// 스왑 슬롯을 점유하고 있다면 비어있는 상태로 표시해 다른 페이지가 사용할 수 있게 함
+	// (스왑 아웃된 적이 없거나 이미 복구된 페이지라면 아무 작업도 하지 않음)
+	anon_swap_release(page);
 }
\ No newline at end of file
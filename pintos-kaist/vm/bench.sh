@@ -0,0 +1,114 @@
+#!/bin/bash
+# VM 폴트 처리량 벤치마크
+#
+# tests/vm의 page-* 워크로드와 SPT 조회 마이크로벤치마크(spt-lookup)를 실행하고, 종료 시 출력되는 통계에서
+# 소요 tick(Timer), 처리한 페이지 폴트 수(VM), 스왑 디스크(hd1:1)에 내린
+# 명령 수를 모아 표로 보여줍니다.
+#
+# 사용법: ./bench.sh [-b <git-rev> | -e <policy,...>] [test ...]
+#   -b <git-rev>     : 같은 워크로드를 <git-rev>의 커널로도 실행해 나란히 비교합니다.
+#   -e <policy,...>  : 같은 워크로드를 교체 정책(커널 옵션 -evict=POLICY)마다 실행해
+#                      통과 여부, 폴트 수, 교체 수, 스왑 명령 수를 정책별로 비교합니다.
+#                      "all"이면 clock, fifo, lru, 2q를 모두 돌립니다.
+#   test             : 실행할 테스트 이름 (기본값: page-*, swap-*, spt-lookup)
+
+DEFAULT_TESTS="page-linear page-parallel page-merge-seq page-merge-par page-merge-stk page-merge-mm page-shuffle swap-anon swap-iter swap-fork spt-lookup"
+
+VM_DIR="$( cd -P "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+PATH="$VM_DIR/../utils:$PATH"
+
+ALL_POLICIES="clock fifo lru 2q"
+USAGE="Usage: $0 [-b <git-rev> | -e <policy,...>] [test ...]"
+
+BASE_REV=""
+POLICIES=""
+case "$1" in
+  -b|-e)
+    if [ $# -lt 2 ]; then
+      echo "$USAGE"
+      exit 1
+    fi
+    if [ "$1" = "-b" ]; then
+      BASE_REV="$2"
+    elif [ "$2" = "all" ]; then
+      POLICIES="$ALL_POLICIES"
+    else
+      POLICIES="${2//,/ }"
+    fi
+    shift 2
+    ;;
+esac
+TESTS="${*:-$DEFAULT_TESTS}"
+
+# run_suite <vm 디렉터리> [커널 옵션] :
+#   각 테스트의 "이름 tick 폴트수 스왑명령수 교체수 결과"를 한 줄씩 출력
+#   커널 옵션은 환경 변수 KERNELFLAGS로 넘겨 Make.tests에 있는 테스트별 옵션 뒤에 덧붙입니다.
+run_suite() {
+  local dir="$1" flags="$2"
+  make -C "$dir" -j >/dev/null 2>&1 || { echo "build failed in $dir" >&2; exit 1; }
+  for t in $TESTS; do
+    rm -f "$dir/build/tests/vm/$t.output" "$dir/build/tests/vm/$t.result"
+    KERNELFLAGS="$flags" make -C "$dir/build" "tests/vm/$t.result" >/dev/null 2>&1
+    awk -v name="$t" -v result="$(head -n 1 "$dir/build/tests/vm/$t.result" 2>/dev/null)" '
+      /^Timer: [0-9]+ ticks/ { ticks = $2 }
+      /^VM: [0-9]+ faults/   { faults = $2; evictions = $4 }
+      /^hd1:1: .*commands\)/ { gsub(/[(,]/, ""); cmds = $6 + $9 }
+      /^hd1:1: [0-9]+ reads, [0-9]+ writes$/ { cmds = $2 + $4 }
+      END { printf "%s %s %s %s %s %s\n", name, (ticks == "" ? "-" : ticks),
+                   (faults == "" ? "-" : faults), (cmds == "" ? "-" : cmds),
+                   (evictions == "" ? "-" : evictions), (result == "" ? "-" : result) }
+    ' "$dir/build/tests/vm/$t.output"
+  done
+}
+
+# 교체 정책 비교: 정책마다 같은 워크로드를 돌려 한 표에 모읍니다.
+if [ -n "$POLICIES" ]; then
+  printf "%-16s %-6s %6s %10s %10s %10s %10s\n" "test" "policy" "result" "ticks" "faults" \
+    "evictions" "swap cmds"
+  RUNS=$(mktemp)
+  for p in $POLICIES; do
+    run_suite "$VM_DIR" "-evict=$p" | awk -v policy="$p" '{ print $0, policy }' >> "$RUNS"
+  done
+  for t in $TESTS; do
+    awk -v name="$t" '$1 == name {
+      printf "%-16s %-6s %6s %10s %10s %10s %10s\n", $1, $7, $6, $2, $3, $5, $4 }' "$RUNS"
+  done
+  echo
+  for p in $POLICIES; do
+    awk -v policy="$p" '$7 == policy { runs++; pass += ($6 == "PASS"); faults += $3; evictions += $5; cmds += $4 }
+      END { printf "%-16s %-6s %6s %10s %10d %10d %10d\n", "total", policy, pass "/" runs, "",
+                   faults, evictions, cmds }' "$RUNS"
+  done
+  rm -f "$RUNS"
+  exit 0
+fi
+
+CUR=$(mktemp)
+run_suite "$VM_DIR" > "$CUR"
+
+if [ -z "$BASE_REV" ]; then
+  printf "%-16s %10s %10s %14s %10s\n" "test" "ticks" "faults" "faults/ktick" "swap cmds"
+  awk '{ rate = ($2 > 0 && $3 != "-") ? sprintf("%.1f", $3 * 1000 / $2) : "-";
+         printf "%-16s %10s %10s %14s %10s\n", $1, $2, $3, rate, $4 }' "$CUR"
+  rm -f "$CUR"
+  exit 0
+fi
+
+# 비교 대상 리비전을 임시 worktree에 빌드하여 같은 워크로드를 실행합니다.
+REPO_ROOT=$(git -C "$VM_DIR" rev-parse --show-toplevel)
+SUBDIR=$(git -C "$VM_DIR" rev-parse --show-prefix)
+WORKTREE=$(mktemp -d)
+git -C "$REPO_ROOT" worktree add -q --detach "$WORKTREE" "$BASE_REV" || exit 1
+BASE=$(mktemp)
+run_suite "$WORKTREE/$SUBDIR" > "$BASE"
+git -C "$REPO_ROOT" worktree remove --force "$WORKTREE"
+
+printf "%-16s %12s %12s %10s %12s %12s %10s %8s\n" "test" "base ticks" "base faults" "base cmds" \
+  "ticks" "faults" "cmds" "speedup"
+awk 'NR == FNR { ticks[$1] = $2; faults[$1] = $3; cmds[$1] = $4; next }
+  {
+    speedup = ($2 > 0 && ticks[$1] != "-") ? sprintf("%.2fx", ticks[$1] / $2) : "-";
+    printf "%-16s %12s %12s %10s %12s %12s %10s %8s\n", $1, ticks[$1], faults[$1], cmds[$1],
+      $2, $3, $4, speedup
+  }' "$BASE" "$CUR"
+rm -f "$CUR" "$BASE"
@@ -0,0 +1,356 @@
+/* evict.c: 페이지 교체 정책.
+ *
+ * 프레임 테이블(vm.c)은 프레임이 쓰이기 시작하고(insert), 비워지고(remove),
+ * 페이지가 매핑될 때(mapped) 정책에 알리고, 프레임이 모자라면 victim을 고르게(select) 합니다.
+ * 고른 프레임을 실제로 내보내는 일과 대형 페이지를 쪼개는 일은 vm.c가 맡습니다.
+ * 정책은 커널 커맨드라인 옵션 "-evict=POLICY"로 고르며, 모든 훅은 frame_lock 아래에서 불립니다.
+ *
+ * - clock: WSClock. 기본값입니다.
+ * - fifo: second-chance FIFO. 들어온 순서대로 보되 최근에 접근된 프레임은 큐 뒤로 보냅니다.
+ * - lru: 프레임마다 8비트 age를 두고 타이머 틱마다 한 칸씩 밀어 넣는 aging으로 LRU를 근사합니다.
+ * - 2q: 처음 들어온 프레임은 A1in FIFO에 두고, A1in에서 쫓겨난 지 얼마 안 되어 다시 폴트가 난
+ *   페이지만 Am(second chance)으로 올립니다. 한 번 훑고 지나가는 스캔이 Am의 작업 집합을
+ *   밀어내지 못합니다. ARC의 ghost 리스트 대신 쫓겨난 페이지를 기억하는 고정 크기 표를 쓰며,
+ *   "arc"도 이 정책을 고릅니다. */
+
+#include "vm/evict.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "vm/vm.h"
+
+/* 교체 정책. select 외의 훅은 NULL이면 부르지 않습니다. */
+struct evict_policy
+{
+	const char *name;
+	void (*init)(void);
+	void (*insert)(struct frame *frame);
+	void (*remove)(struct frame *frame);
+	void (*mapped)(struct frame *frame, struct page *page);
+	struct frame *(*select)(void);
+};
+
+static struct frame *frames; /* 프레임 테이블 */
+static size_t frame_cnt;
+
+/* fifo와 2q가 프레임을 담는 큐. frame->policy_queue가 프레임이 든 큐입니다. */
+enum
+{
+	QUEUE_NONE,
+	QUEUE_FIFO, /* fifo */
+	QUEUE_A1IN, /* 2q: 처음 들어온 프레임 */
+	QUEUE_AM,   /* 2q: 다시 쓰인 것이 확인된 프레임 */
+	QUEUE_CNT
+};
+static struct list queues[QUEUE_CNT];
+static size_t queue_len[QUEUE_CNT];
+
+static void
+queue_push(struct frame *frame, int queue)
+{
+	ASSERT(frame->policy_queue == QUEUE_NONE);
+	list_push_back(&queues[queue], &frame->policy_elem);
+	queue_len[queue]++;
+	frame->policy_queue = queue;
+}
+
+static void
+queue_remove(struct frame *frame)
+{
+	if (frame->policy_queue == QUEUE_NONE)
+		return;
+	list_remove(&frame->policy_elem);
+	queue_len[frame->policy_queue]--;
+	frame->policy_queue = QUEUE_NONE;
+}
+
+/* FRAME을 들어 있는 큐의 맨 뒤로 보냅니다. */
+static void
+queue_rotate(struct frame *frame)
+{
+	list_remove(&frame->policy_elem);
+	list_push_back(&queues[frame->policy_queue], &frame->policy_elem);
+}
+
+/* QUEUE를 앞에서부터 훑어 최근에 접근되지 않은 프레임을 고릅니다.
+ * 지나친 프레임과 고른 프레임은 모두 큐 뒤로 보내므로, 한 바퀴를 돌면 accessed 비트가
+ * 모두 지워져 두 바퀴 안에 victim이 나옵니다. */
+static struct frame *
+queue_second_chance(int queue)
+{
+	for (size_t scanned = queue_len[queue] * 2; scanned > 0; scanned--)
+	{
+		struct frame *frame = list_entry(list_front(&queues[queue]), struct frame, policy_elem);
+		queue_rotate(frame);
+		if (frame_evictable(frame) && !frame_test_and_clear_accessed(frame))
+			return frame;
+	}
+	return NULL;
+}
+
+/* QUEUE에서 가장 먼저 들어온, 교체할 수 있는 프레임을 고릅니다. 접근 여부는 보지 않습니다. */
+static struct frame *
+queue_oldest(int queue)
+{
+	struct list_elem *e;
+
+	for (e = list_begin(&queues[queue]); e != list_end(&queues[queue]); e = list_next(e))
+	{
+		struct frame *frame = list_entry(e, struct frame, policy_elem);
+		if (frame_evictable(frame))
+			return frame;
+	}
+	return NULL;
+}
+
+/* clock: WSClock.
+ * 최근에 접근되지 않은 프레임 중에서도 I/O 없이 비울 수 있는 깨끗한 프레임
+ * (실행 코드, 수정되지 않은 mmap 페이지, swap-in 뒤로 쓰이지 않은 익명 페이지)을 먼저 고릅니다. dirty한 후보는 건너뛰되
+ * 처음 만난 것을 예비로 기억해 두었다가, 그 뒤 WSCLOCK_LOOKAHEAD개 프레임 안에
+ * 깨끗한 프레임이 없으면 그것을 고릅니다.
+ * 건너뛴 dirty 프레임은 cleaning 큐에 넣어 회수 스레드가 미리 기록하게 하므로
+ * 다음 바퀴에는 깨끗한 프레임이 되어 있습니다.
+ * 프레임 테이블이 연속된 배열이므로 clock hand는 인덱스만 증가시킵니다. */
+#define WSCLOCK_LOOKAHEAD 32
+static size_t clock_hand;
+
+static struct frame *
+clock_select(void)
+{
+	struct frame *dirty = NULL; /* 처음 건너뛴 dirty 후보 */
+	size_t dirty_hand = 0;      /* dirty 후보 바로 다음 clock hand 위치 */
+	size_t lookahead = 0;
+
+	/* 한 바퀴를 돌면 모든 accessed 비트가 지워지므로 두 바퀴 안에 victim이 나옵니다 */
+	for (size_t scanned = 0; scanned < frame_cnt * 2; scanned++)
+	{
+		/* dirty 후보를 찾은 뒤에는 깨끗한 프레임을 WSCLOCK_LOOKAHEAD개 프레임까지만 더 찾습니다 */
+		if (dirty != NULL && lookahead++ >= WSCLOCK_LOOKAHEAD)
+			break;
+		struct frame *frame = &frames[clock_hand];
+		if (++clock_hand == frame_cnt)
+			clock_hand = 0;
+
+		if (!frame_evictable(frame) || frame == dirty || frame_test_and_clear_accessed(frame))
+			continue;
+		/* 대형 페이지는 항상 익명 메모리이므로 dirty 후보가 됩니다 */
+		if (frame_is_clean(frame))
+			return frame;
+		frame_queue_clean(frame);
+		if (dirty == NULL)
+		{
+			dirty = frame;
+			dirty_hand = clock_hand;
+		}
+	}
+	/* 건너뛴 프레임들은 다음 호출에서 다시 보도록 hand를 되돌립니다 */
+	if (dirty != NULL)
+		clock_hand = dirty_hand;
+	return dirty;
+}
+
+/* fifo: second-chance FIFO */
+static void
+fifo_insert(struct frame *frame)
+{
+	queue_push(frame, QUEUE_FIFO);
+}
+
+static struct frame *
+fifo_select(void)
+{
+	return queue_second_chance(QUEUE_FIFO);
+}
+
+/* lru: aging.
+ * 고를 때마다 교체 후보의 accessed 비트를 age의 최상위 비트로 모으고,
+ * 타이머 틱이 바뀌었으면 그 전에 age를 한 칸 오른쪽으로 밉니다. 따라서 age는
+ * 최근 8틱 동안 프레임이 쓰인 틱들을 나타내며, 가장 작은 프레임이 가장 오래전에 쓰인 것입니다.
+ * 고를 때마다 프레임 테이블 전체를 훑으므로 다른 정책보다 비용이 큽니다. */
+#define LRU_REFERENCED 0x80
+static size_t lru_hand;         /* 같은 age끼리는 여기서부터 먼저 만나는 프레임을 고릅니다 */
+static int64_t lru_aged_tick;   /* 마지막으로 age를 민 틱 */
+
+static void
+lru_insert(struct frame *frame)
+{
+	/* 방금 올라온 프레임은 이번 틱에 쓰인 것으로 칩니다 */
+	frame->age = LRU_REFERENCED;
+}
+
+static struct frame *
+lru_select(void)
+{
+	struct frame *victim = NULL;
+	size_t victim_idx = 0;
+	int64_t now = timer_ticks();
+	bool shift = now != lru_aged_tick;
+
+	lru_aged_tick = now;
+	for (size_t i = 0; i < frame_cnt; i++)
+	{
+		size_t idx = (lru_hand + i) % frame_cnt;
+		struct frame *frame = &frames[idx];
+
+		if (!frame_evictable(frame))
+			continue;
+		if (shift)
+			frame->age >>= 1;
+		if (frame_test_and_clear_accessed(frame))
+			frame->age |= LRU_REFERENCED;
+		if (victim == NULL || frame->age < victim->age)
+		{
+			victim = frame;
+			victim_idx = idx;
+		}
+	}
+	if (victim != NULL)
+		lru_hand = (victim_idx + 1) % frame_cnt;
+	return victim;
+}
+
+/* 2q: A1in은 추적하는 프레임의 1/4을 목표 크기로 삼습니다.
+ * ghost 표는 A1in에서 쫓겨난 페이지의 (주소 공간, 가상 주소) 키를 프레임 수의 절반만큼
+ * 직접 사상(direct-mapped) 방식으로 기억합니다. 충돌하면 오래된 키를 덮어쓸 뿐이므로
+ * 표가 잊은 페이지는 다시 A1in으로 들어올 뿐입니다. */
+static uint64_t *ghosts;
+static size_t ghost_cnt;
+
+static uint64_t
+ghost_key(struct page *page)
+{
+	/* 0은 빈 슬롯을 뜻하므로 최하위 비트를 켭니다 (va는 페이지 정렬되어 있습니다) */
+	return ((uint64_t)page->pml4 ^ ((uint64_t)page->va * 0x9e3779b97f4a7c15ULL)) | 1;
+}
+
+static void
+twoq_init(void)
+{
+	ghost_cnt = frame_cnt / 2 > 0 ? frame_cnt / 2 : 1;
+	ghosts = palloc_get_multiple(PAL_ASSERT | PAL_ZERO,
+								 DIV_ROUND_UP(ghost_cnt * sizeof *ghosts, PGSIZE));
+}
+
+static void
+twoq_insert(struct frame *frame)
+{
+	queue_push(frame, QUEUE_A1IN);
+}
+
+/* A1in에 막 들어온 프레임에 최근 A1in에서 쫓겨난 페이지가 다시 매핑되면 Am으로 올립니다. */
+static void
+twoq_mapped(struct frame *frame, struct page *page)
+{
+	if (frame->policy_queue != QUEUE_A1IN)
+		return;
+
+	uint64_t key = ghost_key(page);
+	uint64_t *slot = &ghosts[key % ghost_cnt];
+	if (*slot == key)
+	{
+		*slot = 0;
+		queue_remove(frame);
+		queue_push(frame, QUEUE_AM);
+	}
+}
+
+static struct frame *
+twoq_select(void)
+{
+	size_t a1in_target = (queue_len[QUEUE_A1IN] + queue_len[QUEUE_AM]) / 4;
+	struct frame *victim = NULL;
+	struct list_elem *e;
+
+	/* A1in이 목표보다 크면 A1in에서, 아니면 Am에서 고르고, 고를 수 없으면 다른 쪽을 봅니다 */
+	if (queue_len[QUEUE_A1IN] > a1in_target)
+		victim = queue_oldest(QUEUE_A1IN);
+	if (victim == NULL)
+		victim = queue_second_chance(QUEUE_AM);
+	if (victim == NULL)
+		victim = queue_oldest(QUEUE_A1IN);
+
+	if (victim != NULL && victim->policy_queue == QUEUE_A1IN)
+		for (e = list_begin(&victim->mappings); e != list_end(&victim->mappings); e = list_next(e))
+		{
+			uint64_t key = ghost_key(list_entry(e, struct page, map_elem));
+			ghosts[key % ghost_cnt] = key;
+		}
+	return victim;
+}
+
+static const struct evict_policy policies[] = {
+	{"clock", NULL, NULL, NULL, NULL, clock_select},
+	{"fifo", NULL, fifo_insert, queue_remove, NULL, fifo_select},
+	{"lru", NULL, lru_insert, NULL, NULL, lru_select},
+	{"2q", twoq_init, twoq_insert, queue_remove, twoq_mapped, twoq_select},
+};
+static const struct evict_policy *policy = &policies[0];
+
+/* 이름이 NAME인 정책을 고릅니다. 그런 정책이 없으면 false.
+ * evict_init() 전에 불러야 합니다. */
+bool
+evict_set_policy(const char *name)
+{
+	if (!strcmp(name, "arc"))
+		name = "2q";
+	for (size_t i = 0; i < sizeof policies / sizeof *policies; i++)
+		if (!strcmp(name, policies[i].name))
+		{
+			policy = &policies[i];
+			return true;
+		}
+	return false;
+}
+
+const char *
+evict_policy_name(void)
+{
+	return policy->name;
+}
+
+/* CNT개 프레임으로 이루어진 프레임 테이블 TABLE로 정책을 초기화합니다. */
+void
+evict_init(struct frame *table, size_t cnt)
+{
+	frames = table;
+	frame_cnt = cnt;
+	for (int i = 0; i < QUEUE_CNT; i++)
+		list_init(&queues[i]);
+	if (policy->init != NULL)
+		policy->init();
+}
+
+/* FRAME이 새 내용을 담기 시작했습니다. */
+void
+evict_insert(struct frame *frame)
+{
+	if (policy->insert != NULL)
+		policy->insert(frame);
+}
+
+/* FRAME이 비워졌습니다. 추적하지 않는 프레임이어도 됩니다. */
+void
+evict_remove(struct frame *frame)
+{
+	if (policy->remove != NULL)
+		policy->remove(frame);
+}
+
+/* PAGE가 FRAME에 매핑되었습니다. */
+void
+evict_mapped(struct frame *frame, struct page *page)
+{
+	if (policy->mapped != NULL)
+		policy->mapped(frame, page);
+}
+
+/* 내보낼 프레임을 고릅니다. 고를 수 있는 프레임이 없으면 NULL.
+ * 고른 프레임은 frame_evictable()을 만족합니다. */
+struct frame *
+evict_select(void)
+{
+	return policy->select();
+}
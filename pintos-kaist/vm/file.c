@@ -5,12 +5,15 @@
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
 #include "string.h"
+#include "threads/malloc.h"
 
 struct lock filesys_lock;
 
 static bool file_backed_swap_in(struct page *page, void *kva);
 static bool file_backed_swap_out(struct page *page);
 static void file_backed_destroy(struct page *page);
+static bool text_swap_out(struct page *page);
+static void text_destroy(struct page *page);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations file_ops = {
@@ -20,13 +23,43 @@ static const struct page_operations file_ops = {
 	.type = VM_FILE,
 };
 
+/* 읽기 전용 실행 코드 페이지.
+ * 내용이 항상 실행 파일과 같으므로 교체할 때 기록할 것이 없고, 다시 올릴 때는
+ * 파일에서 읽습니다. 메타데이터는 file_page를 그대로 사용합니다. */
+static const struct page_operations text_ops = {
+	.swap_in = file_backed_swap_in,
+	.swap_out = text_swap_out,
+	.destroy = text_destroy,
+	.type = VM_TEXT,
+};
+
+/*	aux에 저장된 구간 디스크립터(struct segment)로부터 이 페이지의 파일 정보를 계산해
+	swap in/out에 쓸 수 있도록 file_page에 저장합니다.
+	파일 핸들은 구간이 소유하므로 페이지가 살아 있는 동안 구간 참조를 하나 잡아 둡니다.
+*/
+static void
+file_page_setup(struct page *page)
+{
+	/* uninit과 file_page는 union이므로 aux를 먼저 읽어 둔 뒤 덮어씁니다 */
+	struct segment *seg = (struct segment *)page->uninit.aux;
+	off_t backup_offset = segment_page_offset(seg, page->va);		 // 파일 내 오프셋
+	size_t read_byte = segment_page_read_bytes(seg, page->va);	 // 파일에서 읽어올 바이트 수
+
+	struct file_page *file_page = &page->file;
+	/* swap out을 대비해 저장 */
+	file_page->seg = segment_get(seg);
+	file_page->file = seg->file;
+	file_page->offset = backup_offset;
+	file_page->read_byte = read_byte;
+	file_page->zero_byte = PGSIZE - read_byte;
+}
+
 /* The initializer of file vm */
 void vm_file_init(void)
 {
-	/*	현재 스레드의 mmmap_list를 초기화
-		mmap_list는 이 스레드가 mmap()을 통해 매핑한 파일 정보를 저장하는 리스트
+	/*	mmap 영역은 프로세스마다 supplemental_page_table의 vmas가 관리하므로
+		전역으로 준비할 것은 없습니다.
 	*/
-	list_init(&thread_current()->mmap_list);
 }
 
 /* Initialize the file backed page */
@@ -34,38 +67,37 @@ void vm_file_init(void)
 	해당 페이지에 필요한 파일, 오프셋, 읽을 바이트 수 등의 정보를 설정 
 	또한 이후 파일에서 데이터를 swap in/out할 수 있도록 관련 정보를 file_page 구조체에 저장함
 */
-bool file_backed_initializer(struct page *page, enum vm_type type, void *kva)
+bool file_backed_initializer(struct page *page, enum vm_type type UNUSED, void *kva UNUSED)
 {
 	/* Set up the handler */
 	/* 페이지가 file-backed임을 나타내는 핸들러(operations)를 설정 */
 	page->operations = &file_ops;
+	file_page_setup(page);
+	return true;
+}
 
-	/*	aux에 저장된 mmap_info와 Lazy_Load_info 정보를 가져옴
-		mmap_info는 mmap()으로 생성된 매핑 정보를 담고 있으며
-		그 내부의 info 필드에 lazy_load_info가 들어 있음	
-	*/
-	struct mmap_info *mapping_info = (struct mmap_info *)page->uninit.aux;
-	struct lazy_load_info *info = (struct lazy_load_info *)mapping_info->info;
-
-
-	/*	lazy_load_info로부터 파일 매핑에 필요한 정보들을 꺼냄 */
-	struct file *backup_file = info->file;				// 매핑할 파일
-	off_t backup_offset = info->offset;					// 파일 내 오프셋
-	size_t read_byte = info->readbyte;					// 파일에서 읽어올 바이트 수
-	size_t zero_byte = info->zerobyte;					// 나머지를 0으로 채울 바이트 수
-	int mapping_count = mapping_info->mapping_count;	// 매핑 식별용 ID(보통 mmap_id)
-
-	struct file_page *file_page = &page->file;
-	/* swap out을 대비해 저장 */
-	file_page->file = backup_file;
-	file_page->offset = backup_offset;
-	file_page->read_byte = read_byte;
-	file_page->zero_byte = zero_byte;
-	file_page->mapping_count = mapping_count;
+/* 실행 코드 페이지를 초기화합니다. */
+bool text_initializer(struct page *page, enum vm_type type UNUSED, void *kva UNUSED)
+{
+	page->operations = &text_ops;
+	file_page_setup(page);
+	return true;
+}
 
+/* 실행 코드 페이지는 수정되지 않으므로 기록 없이 내보냅니다. */
+static bool
+text_swap_out(struct page *page UNUSED)
+{
 	return true;
 }
 
+/* 실행 코드 페이지가 들고 있던 파일 핸들을 닫습니다. */
+static void
+text_destroy(struct page *page)
+{
+	segment_put(page->file.seg);
+}
+
 /* 파일에서 내용을 읽어와 페이지를 스왑인합니다. */
 static bool
 file_backed_swap_in(struct page *page, void *kva)
@@ -112,45 +144,48 @@ file_backed_swap_out(struct page *page)
 	 * file_write를 사용하면 될 것 같아요
 	 * dirty_bit 초기화 (pml4_set_dirty)
 	 */
-	struct thread *curr = thread_current();
-	bool dirty_bit = pml4_is_dirty(curr->pml4, page->va);
+	/* 다른 프로세스가 교체하는 경우도 있으므로 캐시된 PTE로 확인합니다 */
+	bool dirty_bit = page_is_dirty(page);
 
 	// dirty bit가 true이면, 즉 메모리에서 수정된 경우
 	if (dirty_bit == true)
 	{
-		// 공유 자원 접근 → 락 걸고 접근
-		lock_acquire(&filesys_lock);
-		if (file_write_at(file_page->file,		// mmap된 파일 객체
-						  page->frame->kva,		// 페이지의 실제 물리 주소
-						  file_page->read_byte, // 실제로 파일에 기록할 바이트 수
-						  file_page->offset)	// 파일 내 시작 위치
-			!= (off_t)file_page->read_byte)
-		{
-			// write 실패하면 lock 해제 해야겠지?
-			lock_release(&filesys_lock);
+		if (!file_backed_write_back(page))
 			return false;
-		}
-		// 파일 쓰기 완료 후 락 해제
-		lock_release(&filesys_lock);
 
 		// 더티 비트 클리어(쓰기 완!)
-		pml4_set_dirty(curr->pml4, page->va, false);
+		page_set_dirty(page, false);
 	}
-	// 초기화는 victim에서
-	page->frame->page = NULL;
-	page->frame = NULL;
+	// 페이지와 프레임의 연결은 vm_evict_frame이 끊습니다
 
 	return true;
 }
 
+/* 프레임에 올라와 있는 파일 페이지의 내용을 파일에 기록합니다. dirty 비트는 건드리지 않습니다.
+ * 교체(swap_out), 해제(destroy) 외에 msync와 백그라운드 flusher가 프레임을 내리지 않고 쓸 때도 부릅니다.
+ * 파일에 다 쓰지 못하면 false를 반환합니다. */
+bool
+file_backed_write_back(struct page *page)
+{
+	struct file_page *file_page = &page->file;
+
+	// 공유 자원 접근 → 락 걸고 접근
+	lock_acquire(&filesys_lock);
+	off_t written = file_write_at(file_page->file,		 // mmap된 파일 객체
+								  page->frame->kva,		 // 페이지의 실제 물리 주소
+								  file_page->read_byte, // 실제로 파일에 기록할 바이트 수
+								  file_page->offset);	 // 파일 내 시작 위치
+	lock_release(&filesys_lock);
+
+	return written == (off_t)file_page->read_byte;
+}
+
 /* 
  * 파일 기반(file-backed) 페이지를 소멸시키는 함수입니다.
  *
  * - 해당 페이지가 dirty(변경됨) 상태이면, 파일에 변경 내용을 다시 저장(write-back)합니다.
- * - 이후 페이지가 물리 프레임에 매핑되어 있다면 해당 메모리를 해제합니다.
- * - 마지막으로 사용자 가상 주소 공간에서 이 페이지를 제거합니다.
  *
- * ※ 주의: 페이지 구조체 자체(page)는 호출자가 해제합니다.
+ * ※ 주의: 프레임 반환과 매핑 제거, 페이지 구조체(page) 해제는 호출자가 합니다.
  */
 static void
 file_backed_destroy(struct page *page)
@@ -158,191 +193,152 @@ file_backed_destroy(struct page *page)
 	// file_page는 해당 페이지의 파일 매핑 관련 메타데이터를 담고 있음
 	struct file_page *file_page UNUSED = &page->file;
 
-	struct thread *curr = thread_current();
-
 	// 해당 파일이 읽기 전용으로 열렸을 수 있으므로 쓰기 가능하게 설정
 	file_allow_write(file_page->file);
 
 	/* Dirty bit 검사:
 	   - CPU가 페이지를 수정했다면 dirty bit가 1로 설정됨.
 	   - 이런 경우, 메모리 내용이 파일 내용과 다르므로 파일에 다시 저장(write back)해야 함.
-	   - pml4_is_dirty(): 현재 페이지의 dirty 여부 확인 (PML4 테이블 기준)
+	   - page_is_dirty(): 캐시된 PTE로 dirty 여부 확인 (프레임이 없으면 false)
 	*/
-	if (pml4_is_dirty(curr->pml4, page->va))
+	if (page_is_dirty(page))
 	{
-		lock_acquire(&filesys_lock);  // 파일 시스템 동시 접근 방지
-
-		// file_write_at: 파일의 특정 offset에 메모리 내용을 씀
-		off_t written = file_write_at(
-			file_page->file,          // 매핑된 파일 객체
-			page->frame->kva,         // 해당 페이지의 실제 물리 메모리 주소
-			file_page->read_byte,     // 파일에 써야 할 크기
-			file_page->offset);       // 파일 내에서 쓰기 시작할 오프셋
-
-		lock_release(&filesys_lock);
-
 		// 실제로 기대한 만큼 정확히 썼는지 확인
-		ASSERT(written == file_page->read_byte);
+		bool written = file_backed_write_back(page);
+		ASSERT(written);
 
 		// dirty 비트를 다시 0(false)으로 설정하여 "변경 없음" 상태로 초기화
-		pml4_set_dirty(curr->pml4, page->va, false);
+		page_set_dirty(page, false);
 	}
 
-	/* 페이지가 물리 메모리에 매핑되어 있는 경우:
-	   - palloc_free_page(): 물리 프레임에서 페이지 해제
-	   - frame 자체도 malloc 등으로 할당된 경우, 메모리 해제 필요
-	*/
-	if (page->frame != NULL && page->frame->ref_cnt < 1)
+	/* 프레임 해제와 사용자 가상 주소 공간의 매핑 제거는
+	   vm_dealloc_page가 역매핑을 통해 처리합니다. */
+	segment_put(file_page->seg);
+}
+
+/*	UPAGE에서 시작해 FILE의 OFFSET부터 READ_BYTES 바이트를 담는 구간 디스크립터를 만듭니다.
+	FILE의 소유권은 디스크립터로 넘어가며, 마지막 참조가 사라질 때 닫힙니다.
+	만든 쪽이 참조 하나를 가진 채로 반환하며, 실패하면 FILE을 닫고 NULL을 반환합니다.
+*/
+struct segment *segment_create(struct file *file, void *upage, off_t offset, size_t read_bytes)
+{
+	if (file == NULL)
+		return NULL;
+
+	struct segment *seg = malloc(sizeof(struct segment));
+	if (seg == NULL)
 	{
-		palloc_free_page(page->frame->kva); // 페이지 해제
-		free(page->frame);                  // frame 구조체도 해제
-		page->frame = NULL;
+		file_close(file);
+		return NULL;
 	}
-
-	// 사용자 가상 주소 공간에서 이 페이지에 대한 매핑 제거
-	pml4_clear_page(curr->pml4, page->va);
+	seg->file = file;
+	seg->upage = upage;
+	seg->offset = offset;
+	seg->read_bytes = read_bytes;
+	seg->ref_cnt = 1;
+	return seg;
 }
 
-struct lazy_load_info *make_info(
-	struct file *file, off_t offset, size_t read_byte)
+/*	SEG의 참조를 하나 늘리고 SEG를 반환합니다.
+	fork한 자식과도 공유하므로 참조 수는 원자적으로 바꿉니다.
+*/
+struct segment *segment_get(struct segment *seg)
 {
-	struct lazy_load_info *info = malloc(sizeof(struct lazy_load_info));
-	info->file = file;
-	info->offset = offset;
-	info->readbyte = read_byte;
-	info->zerobyte = PGSIZE - read_byte;
-	return info;
+	__atomic_add_fetch(&seg->ref_cnt, 1, __ATOMIC_RELAXED);
+	return seg;
 }
 
-struct mmap_info *make_mmap_info(struct lazy_load_info *info, int mapping_count)
+/* SEG의 참조를 하나 놓고, 마지막 참조였으면 파일을 닫고 해제합니다. */
+void segment_put(struct segment *seg)
 {
-	struct mmap_info *mmap_info = malloc(sizeof(struct mmap_info));
-	mmap_info->info = info;
-	mmap_info->mapping_count = mapping_count;
-	return mmap_info;
+	if (__atomic_sub_fetch(&seg->ref_cnt, 1, __ATOMIC_ACQ_REL) == 0)
+	{
+		file_close(seg->file);
+		free(seg);
+	}
 }
 
 /* Do the mmap */
+/*	FILE의 OFFSET부터를 ADDR에서 시작하는 LENGTH 바이트 영역에 매핑하고 ADDR을 반환합니다.
+	영역을 먼저 등록하므로 다른 영역과 겹치면 페이지를 하나도 만들지 않고 NULL을 반환합니다.
+	파일 끝을 넘어선 부분은 0으로 채워지는 페이지가 됩니다.
+	FILE이 NULL이면 익명 영역을 등록만 하고, 페이지는 처음 접근할 때 0으로 채워 만듭니다.
+*/
 void *do_mmap(void *addr, size_t length, int writable,
 			  struct file *file, off_t offset)
 {
-	/* 지연 로딩과 스왑 시의 백업 정보 저장 */
-	/* mmap 대상 파일의 전체 크기*/
-	off_t file_size = file_length(file);
-
-	/* offset 이후 실제로 읽을 수 있는 크기 계산 */
-	off_t read_size = file_size - offset;
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	void *end = pg_round_up(addr + length);
+	if (end <= addr || !is_user_vaddr(end - 1))
+		return NULL;
 
-	/* 실제로 읽을 수 있는 크기가 0미만이면 읽을 수 있는 게 없으므로 0으로 설정 */
-	if (read_size < 0) {
-		read_size = 0;
-	}
+	if (file == NULL)
+		return vma_insert(&spt->vmas, addr, end, VMA_ANON, writable) != NULL ? addr : NULL;
 
-	/* 남은 매핑할 파일 길이 */
-	size_t remain_length = (size_t)read_size;
+	/* 영역 등록: 겹침 검사는 영역 수에 대해 O(log n) 입니다 */
+	struct vma *vma = vma_insert(&spt->vmas, addr, end, VMA_MMAP, writable);
+	if (vma == NULL)
+		return NULL;
 
-	/* 현재 매핑 중인 주소 및 파일 offset */
-	void *cur_addr = addr;
-	off_t cur_offset = offset;
+	/* offset 이후 실제로 읽을 수 있는 크기 */
+	off_t file_size = file_length(file);
+	size_t file_remain = file_size > offset ? (size_t)(file_size - offset) : 0;
 
-	/* 	파일은 mmap 동안 읽기 전용으로 reopen 해서 사용됨
-		원본 파일은 fd_table에 유지되므로 별도로 reopen 필요
-	*/
-	struct file *reopen_file = file_reopen(file);
-	/*	mmap은 여러 페이지에 걸쳐 매핑될 수 있습니다.
-		munmap 시에 어디까지 해제해줄 것인지 판단할 기준이 됩니다 
+	/*	영역 전체가 구간 디스크립터 하나를 공유합니다.
+		원본 파일은 fd_table에 남아 닫힐 수 있으므로 구간이 reopen 한 핸들을 소유하고,
+		마지막 페이지가 해제될 때 닫습니다.
+		파일이 모자란 뒤쪽 페이지는 0으로 채워집니다.
 	*/
-	int mapping_count = 0; 
-
-	/* 매핑해야 할 전체 크기를 페이지 단위로 반복하며 처리 */
-	while (remain_length > 0)
+	size_t read_bytes = file_remain < (size_t)(end - addr) ? file_remain : (size_t)(end - addr);
+	struct segment *seg = segment_create(file_reopen(file), addr, offset, read_bytes);
+	if (seg == NULL)
 	{
-		/*	한 페이지(4KB) 단위로 매핑 처리
-			남은 크기가 한 페이지보다 작다면, 그만큼만 할당
-		*/
-		size_t allocate_length = remain_length > PGSIZE ? PGSIZE : remain_length;
-		
-		/*	지연 로딩에 사용할 info 구조체 생성
-			reopen된 파일 핸들, 현재 offset, 읽을 크기 등을 저장
-		*/
-		struct lazy_load_info *info = make_info(reopen_file, cur_offset, allocate_length);
-		
-		/*	mmap 영역이라는 것을 표시하고,
-			해당 매핑에 대한 식별자(mapping_count)를 포함한 구조체 생성
-		*/
-		struct mmap_info *mmap_info = make_mmap_info(info, mapping_count);
-		
-		void *aux = mmap_info;
+		vma_remove(&spt->vmas, vma);
+		return NULL;
+	}
 
+	bool success = true;
+	for (void *cur_addr = addr; cur_addr < end; cur_addr += PGSIZE)
+	{
 		/* mmap 또한 지연 로딩이 필요합니다 */
-		vm_alloc_page_with_initializer(VM_MMAP, cur_addr, writable, lazy_load_segment, aux);
-		/* remain_length는 unsigned 형입니다. 따라서 음수가 없기에 미리 break를 해줘야 합니다 */
-		if (remain_length < PGSIZE)
+		if (!vm_alloc_page_with_initializer(VM_MMAP, cur_addr, writable, lazy_load_segment, segment_get(seg)))
+		{
+			segment_put(seg);
+			success = false;
 			break;
-		
-		/* 다음 페이지를 위해 주소, offset, 남은 길이 갱신 */
-		remain_length -= PGSIZE;
-		cur_addr += PGSIZE;
-		cur_offset += PGSIZE;
-		mapping_count++;
+		}
 	}
-}
+	segment_put(seg);
 
-static bool is_my_mmap(void *addr, struct file *mmap_file, int mmap_count)
-{
-	/* 현재 스레드의 보조 테이블 가져오기 */
-	struct supplemental_page_table *spt = &thread_current()->spt;
-	
-	/* addr에 해당하는 페이지를 보조 테이블에서 찾음 */
-	struct page *find_page = spt_find_page(spt, addr);
-	
-	/* 예외 처리 → 해당 주소에 매핑된 페이지가 존재하지 않으면 false */
-	if (find_page == NULL)
-		return false;
-
-	/* 해당 페이지가 참조하는 있는 파일 객체를 가져옴*/
-	struct file *find_file = find_page->file.file;
-
-	/*	파일이 존재하지 않거나, mmap시 사용된 파일과 다르면 false
-		→ 이는 다른 mmap의 페이지일 가능성이 높음
-	*/
-	if (find_file == NULL || find_file != mmap_file)
-		return false;
-
-	/*	동일한 파일이라 하더라도, mmap 내 인덱스(mapping_count)가 다르면
-		→ 이는 다른 mmap에서 온 페이지일 수 있으므로 false
-	*/
-	if (find_page->file.mapping_count != mmap_count)
-		return false;
-
-	/* 위에 예외 케이스에 안걸린다면 mmap영역의 연속된 페이지임*/
-	return true;
+	if (!success)
+	{
+		do_munmap(addr);
+		return NULL;
+	}
+	return addr;
 }
 
 /* Do the munmap */
+/*	ADDR은 mmap이 돌려준 시작 주소여야 합니다.
+	영역의 범위를 VMA에서 바로 얻으므로 페이지를 하나씩 확인하며 경계를 찾지 않습니다.
+*/
 void do_munmap(void *addr)
 {
 	/* 현재 스레드의 보조 테이블을 가져오기 */
 	struct supplemental_page_table *spt = &thread_current()->spt;
-	/* SPT에 없으면 해제할 수 없습니다 !! */
-	/* 항상 mmap 영역의 첫번째 주소를 준다고 합니다 */
-	struct page *target_page = spt_find_page(spt, addr);
-	if (target_page == NULL)
+	struct vma *vma = vma_find(&spt->vmas, addr);
+	if (vma == NULL || (vma->kind != VMA_MMAP && vma->kind != VMA_ANON) || vma->start != addr)
 		return;
 
-	/* 해당 페이지가 mmap에 의해 매핑된 파일인지 확인*/
-	struct file_page *file_page = &target_page->file;
-	struct file *target_file = file_page->file;			// 넌 어떤 파일이냐...?
-	int target_mmap_count = file_page->mapping_count;	// mmap에서 몇 번째 페이지인지
-
-	addr += PGSIZE; // 다음 mmap_file 찾기
-	/* while 루프를 통해 연속된 페이지가 같은 mmap 영역인지 확인합니다 */
-	while (is_my_mmap(addr, target_file, ++target_mmap_count))
+	/* 영역의 페이지를 모두 해제(dirty면 write-back)한 뒤 영역을 없앱니다.
+	 * TLB 무효화는 모아 두었다가 끝에서 한 번에 합니다 */
+	tlb_batch_begin();
+	for (void *va = vma->start; va < vma->end; va += PGSIZE)
 	{
-		struct page *remove_page = spt_find_page(spt, addr);
-		spt_remove_page(spt, remove_page);
-		addr += PGSIZE;
+		struct page *page = spt_find_page(spt, va);
+		if (page != NULL)
+			spt_remove_page(spt, page);
 	}
-	/* 첫번째 주소를 해제합니다 */
-	spt_remove_page(spt, target_page);
-}
\ No newline at end of file
+	tlb_batch_end();
+	vma_remove(&spt->vmas, vma);
+}
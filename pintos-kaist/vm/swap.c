@@ -0,0 +1,342 @@
+/* swap.c: 스왑 슬롯 할당기.
+ *
+ * 빈 슬롯들을 연속된 구간(extent) 단위로 관리합니다.
+ * - 각 빈 구간은 길이에 따라 크기별 리스트(2의 거듭제곱 단위)에 들어 있고,
+ *   비어 있지 않은 리스트는 class_mask 비트로 표시되어 한 번에 찾을 수 있습니다.
+ * - 구간의 첫 슬롯(머리)에는 길이와 리스트 원소를, 마지막 슬롯(꼬리)에는
+ *   머리 위치를 기록해 두어(boundary tag) 해제할 때 양옆 구간과 바로 합칩니다.
+ * - 마지막으로 할당한 자리 바로 뒤(cursor)에서 먼저 잘라 쓰므로(next-fit)
+ *   연달아 내보낸 페이지들이 디스크에서도 이웃하게 됩니다.
+ * 따라서 할당과 해제 비용은 스왑이 얼마나 차 있는지와 무관하게 일정합니다.
+ *
+ * fork한 프로세스들은 스왑된 페이지를 복사하지 않고 같은 슬롯을 함께 가리키므로
+ * 슬롯마다 참조 수를 두고, 마지막 참조가 놓일 때 빈 구간으로 돌려줍니다. */
+
+#include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <list.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "vm/vm.h"
+
+/* 크기별 빈 구간 리스트의 개수. 리스트 k에는 길이가 [2^k, 2^(k+1))인 구간이 들어갑니다. */
+#define CLASS_CNT 32
+
+/* 슬롯마다 하나씩 두는 boundary tag.
+ * head_len과 elem은 빈 구간의 머리 슬롯에서만, head는 꼬리 슬롯에서만 의미가 있습니다. */
+struct swap_extent
+{
+	size_t head;		   /* 꼬리 슬롯: 이 구간의 머리 슬롯 번호 */
+	size_t head_len;	   /* 머리 슬롯: 이 구간의 길이 */
+	struct list_elem elem; /* 머리 슬롯: 크기별 빈 구간 리스트의 원소 */
+};
+
+static struct lock swap_lock;
+static size_t slot_cnt;
+static struct bitmap *used_map; /* 슬롯별 사용 여부 */
+static struct swap_extent *extents;
+static uint16_t *slot_refs;		/* 슬롯별 참조 수 (이 슬롯을 가리키는 페이지 수) */
+static struct list free_lists[CLASS_CNT];
+static uint32_t class_mask; /* 비어 있지 않은 리스트의 비트 집합 */
+static size_t cursor;		/* next-fit: 다음 할당을 시도할 빈 구간의 머리 */
+
+/* 통계 */
+static size_t used_cnt;			 /* 사용 중인 슬롯 수 */
+static size_t extent_cnt;		 /* 빈 구간 수 */
+static long long alloc_cnt;		 /* 성공한 할당 수 */
+static long long alloc_fail_cnt; /* 연속된 자리가 없어 실패한 할당 수 */
+static long long cursor_hit_cnt; /* cursor 구간에서 바로 잘라 쓴 할당 수 */
+static long long share_cnt;		 /* 슬롯을 복사하지 않고 함께 가리키게 한 횟수 */
+
+/* 초기화 직후 할당기를 스스로 점검할지 여부. 커널 커맨드라인 옵션 "-swap-check"로 켭니다. */
+bool swap_check;
+
+static void swap_self_check(void);
+
+/* 길이 LEN인 구간이 들어갈 리스트 번호 (floor(log2(LEN))) */
+static int
+len_class(size_t len)
+{
+	int class = 63 - __builtin_clzll(len);
+	return class < CLASS_CNT ? class : CLASS_CNT - 1;
+}
+
+/* 슬롯 SLOT이 빈 구간의 머리이면 true */
+static bool
+is_extent_head(size_t slot)
+{
+	return slot < slot_cnt && !bitmap_test(used_map, slot)
+		   && (slot == 0 || bitmap_test(used_map, slot - 1));
+}
+
+/* [HEAD, HEAD + LEN)을 빈 구간으로 등록합니다. */
+static void
+extent_insert(size_t head, size_t len)
+{
+	int class = len_class(len);
+
+	extents[head].head_len = len;
+	extents[head + len - 1].head = head;
+	list_push_back(&free_lists[class], &extents[head].elem);
+	class_mask |= 1u << class;
+	extent_cnt++;
+}
+
+/* 머리가 HEAD인 빈 구간을 리스트에서 빼고 길이를 반환합니다. */
+static size_t
+extent_remove(size_t head)
+{
+	size_t len = extents[head].head_len;
+	int class = len_class(len);
+
+	list_remove(&extents[head].elem);
+	if (list_empty(&free_lists[class]))
+		class_mask &= ~(1u << class);
+	extent_cnt--;
+	return len;
+}
+
+/* 머리가 HEAD인 빈 구간의 앞쪽 CNT개 슬롯을 사용 중으로 만들고 나머지는 다시 등록합니다. */
+static void
+extent_carve(size_t head, size_t cnt)
+{
+	size_t len = extent_remove(head);
+
+	ASSERT(len >= cnt);
+	bitmap_set_multiple(used_map, head, cnt, true);
+	for (size_t i = 0; i < cnt; i++)
+		slot_refs[head + i] = 1;
+	used_cnt += cnt;
+	if (len > cnt)
+		extent_insert(head + cnt, len - cnt);
+	cursor = head + cnt;
+}
+
+/* CNT개의 슬롯을 가진 스왑 공간을 관리하도록 초기화합니다. */
+void
+swap_init(size_t cnt)
+{
+	lock_init(&swap_lock);
+	for (int i = 0; i < CLASS_CNT; i++)
+		list_init(&free_lists[i]);
+
+	slot_cnt = cnt;
+	used_map = bitmap_create(slot_cnt);
+	extents = calloc(slot_cnt > 0 ? slot_cnt : 1, sizeof *extents);
+	slot_refs = calloc(slot_cnt > 0 ? slot_cnt : 1, sizeof *slot_refs);
+	if (used_map == NULL || extents == NULL || slot_refs == NULL)
+		PANIC("swap_init: out of memory");
+
+	if (slot_cnt > 0)
+		extent_insert(0, slot_cnt);
+	cursor = 0;
+
+	if (swap_check)
+		swap_self_check();
+}
+
+/* 연속된 빈 슬롯 CNT개를 할당하고 첫 슬롯 번호를 반환합니다.
+ * 마지막 할당 위치 뒤의 구간에서 먼저 잘라 쓰고(next-fit), 모자라면
+ * 길이가 CNT 이상임이 보장되는 가장 작은 크기 리스트에서 구간을 꺼냅니다.
+ * CNT가 2의 거듭제곱이 아니면 CNT가 속한 리스트(floor(log2(CNT)))에도
+ * 길이가 CNT 이상인 구간이 있을 수 있으므로, 그 리스트의 앞쪽 SWAP_CLUSTER개까지 살펴봅니다.
+ * 그래도 없으면 SWAP_ERROR를 반환합니다. */
+size_t
+swap_alloc(size_t cnt)
+{
+	size_t slot = SWAP_ERROR;
+
+	ASSERT(cnt > 0);
+
+	lock_acquire(&swap_lock);
+	if (is_extent_head(cursor) && extents[cursor].head_len >= cnt)
+	{
+		slot = cursor;
+		cursor_hit_cnt++;
+	}
+	else
+	{
+		/* 리스트 k의 구간은 길이가 2^k 이상이므로 2^k >= CNT인 k부터 찾습니다 */
+		int min_class = cnt == 1 ? 0 : 64 - __builtin_clzll(cnt - 1);
+		uint32_t mask = min_class < CLASS_CNT ? class_mask & ~((1u << min_class) - 1) : 0;
+		if (mask != 0)
+		{
+			struct list *list = &free_lists[__builtin_ctz(mask)];
+			slot = list_entry(list_front(list), struct swap_extent, elem) - extents;
+		}
+		else if ((cnt & (cnt - 1)) != 0)
+		{
+			/* 리스트 floor(log2(CNT))에는 CNT보다 짧은 구간과 긴 구간이 섞여 있습니다 */
+			struct list *list = &free_lists[len_class(cnt)];
+			struct list_elem *e = list_begin(list);
+			for (int i = 0; i < SWAP_CLUSTER && e != list_end(list); i++, e = list_next(e))
+				if (list_entry(e, struct swap_extent, elem)->head_len >= cnt)
+				{
+					slot = list_entry(e, struct swap_extent, elem) - extents;
+					break;
+				}
+		}
+	}
+
+	if (slot != SWAP_ERROR)
+	{
+		extent_carve(slot, cnt);
+		alloc_cnt++;
+	}
+	else
+		alloc_fail_cnt++;
+	lock_release(&swap_lock);
+
+	return slot;
+}
+
+/* 참조가 모두 사라진 [SLOT, SLOT + CNT)를 빈 구간으로 만들고 양옆의 빈 구간과 합칩니다.
+ * swap_lock을 보유한 상태에서 호출해야 합니다. */
+static void
+extent_free(size_t slot, size_t cnt)
+{
+	size_t head = slot, len = cnt;
+
+	bitmap_set_multiple(used_map, slot, cnt, false);
+	used_cnt -= cnt;
+
+	/* 왼쪽 이웃이 비어 있으면 그 꼬리 태그로 머리를 찾아 합칩니다 */
+	if (slot > 0 && !bitmap_test(used_map, slot - 1))
+	{
+		head = extents[slot - 1].head;
+		len += extent_remove(head);
+	}
+	/* 오른쪽 이웃이 비어 있으면 그 구간의 머리가 바로 SLOT + CNT 입니다 */
+	if (slot + cnt < slot_cnt && !bitmap_test(used_map, slot + cnt))
+		len += extent_remove(slot + cnt);
+
+	extent_insert(head, len);
+}
+
+/* SLOT부터 CNT개 슬롯의 참조를 하나씩 놓습니다.
+ * 참조가 0이 된 슬롯들은 이어진 구간 단위로 반환하고 양옆의 빈 구간과 합칩니다. */
+void
+swap_free(size_t slot, size_t cnt)
+{
+	size_t run = 0;
+
+	ASSERT(cnt > 0 && slot + cnt <= slot_cnt);
+
+	lock_acquire(&swap_lock);
+	ASSERT(bitmap_all(used_map, slot, cnt));
+	for (size_t i = 0; i < cnt; i++)
+	{
+		ASSERT(slot_refs[slot + i] > 0);
+		if (--slot_refs[slot + i] == 0)
+			run++;
+		else if (run > 0)
+		{
+			extent_free(slot + i - run, run);
+			run = 0;
+		}
+	}
+	if (run > 0)
+		extent_free(slot + cnt - run, run);
+	lock_release(&swap_lock);
+}
+
+/* 사용 중인 슬롯 SLOT의 참조를 하나 늘립니다.
+ * fork에서 스왑된 페이지를 복사하지 않고 부모와 자식이 함께 가리킬 때 씁니다. */
+void
+swap_share(size_t slot)
+{
+	ASSERT(slot < slot_cnt);
+
+	lock_acquire(&swap_lock);
+	ASSERT(bitmap_test(used_map, slot));
+	ASSERT(slot_refs[slot] < UINT16_MAX);
+	slot_refs[slot]++;
+	share_cnt++;
+	lock_release(&swap_lock);
+}
+
+/* 슬롯 SLOT이 사용 중이면 true를 반환합니다. */
+bool
+swap_in_use(size_t slot)
+{
+	bool in_use;
+
+	lock_acquire(&swap_lock);
+	in_use = bitmap_test(used_map, slot);
+	lock_release(&swap_lock);
+	return in_use;
+}
+
+/* 슬롯의 절반 이상이 사용 중이면 true를 반환합니다.
+ * 스왑이 이만큼 차면 swap-in 한 익명 페이지의 슬롯을 남겨 두지 않고 바로 돌려줍니다. */
+bool
+swap_full(void)
+{
+	bool full;
+
+	lock_acquire(&swap_lock);
+	full = used_cnt * 2 >= slot_cnt;
+	lock_release(&swap_lock);
+	return full;
+}
+
+/* 스왑 공간 사용량과 단편화 정도를 출력합니다.
+ * 단편화는 빈 슬롯 중 가장 큰 빈 구간 밖에 있는 비율입니다. */
+void
+swap_print_stats(void)
+{
+	size_t largest = 0;
+
+	lock_acquire(&swap_lock);
+	if (class_mask != 0)
+	{
+		struct list *list = &free_lists[31 - __builtin_clz(class_mask)];
+		struct list_elem *e;
+		for (e = list_begin(list); e != list_end(list); e = list_next(e))
+		{
+			size_t len = list_entry(e, struct swap_extent, elem)->head_len;
+			if (len > largest)
+				largest = len;
+		}
+	}
+	size_t free_cnt = slot_cnt - used_cnt;
+	printf("Swap slots: %zu of %zu in use, %zu free extents (largest %zu, "
+		   "%zu%% fragmented), %lld allocs (%lld next-fit), %lld failed, %lld shared\n",
+		   used_cnt, slot_cnt, extent_cnt, largest,
+		   free_cnt > 0 ? (free_cnt - largest) * 100 / free_cnt : 0,
+		   alloc_cnt, cursor_hit_cnt, alloc_fail_cnt, share_cnt);
+	lock_release(&swap_lock);
+}
+
+/* 스왑을 단편화한 뒤 2의 거듭제곱이 아닌 묶음이 한 구간에 들어가는지 확인합니다.
+ * 빈 구간으로 [0, 3)과 [4, 5)만 남기고 cursor를 비켜 둔 채 슬롯 3개를 요청하면,
+ * 길이 3인 구간은 리스트 1에 있으므로 리스트 2부터 찾아서는 실패합니다.
+ * 확인이 끝나면 모든 슬롯과 통계를 처음 상태로 되돌립니다. */
+static void
+swap_self_check(void)
+{
+	size_t slot;
+
+	if (slot_cnt < 6)
+		PANIC("swap check: need at least 6 swap slots, have %zu", slot_cnt);
+
+	if (swap_alloc(slot_cnt) != 0)
+		PANIC("swap check: cannot allocate the whole swap space");
+	swap_free(0, 3);
+	swap_free(4, 1);
+
+	slot = swap_alloc(3);
+	if (slot != 0 || extent_cnt != 1)
+		PANIC("swap check: 3-slot cluster got slot %zu with %zu free extents left",
+			  slot, extent_cnt);
+	printf("swap check: 3-slot cluster fits a fragmented 3-slot extent\n");
+
+	swap_free(0, 4);
+	swap_free(5, slot_cnt - 5);
+	ASSERT(used_cnt == 0 && extent_cnt == 1);
+	cursor = 0;
+	alloc_cnt = alloc_fail_cnt = cursor_hit_cnt = 0;
+}
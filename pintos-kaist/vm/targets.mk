@@ -2,4 +2,9 @@ vm_SRC = vm/vm.c          # Main api proxy
 vm_SRC += vm/uninit.c     # Uninitialized page
 vm_SRC += vm/anon.c       # Anonymous page
 vm_SRC += vm/file.c       # File mapped page
+vm_SRC += vm/swap.c       # Swap slot allocator
+vm_SRC += vm/zswap.c      # Compressed swap cache
+vm_SRC += vm/vma.c        # Address-space regions
+vm_SRC += vm/evict.c      # Page replacement policies
+vm_SRC += vm/vmstat.c     # Fault and eviction statistics
 vm_SRC += vm/inspect.c    # Testing utility
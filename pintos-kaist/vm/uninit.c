@@ -9,6 +9,7 @@
 
 #include "vm/vm.h"
 #include "vm/uninit.h"
+#include "userprog/process.h"
 
 static bool uninit_initialize(struct page *page, void *kva);
 static void uninit_destroy(struct page *page);
@@ -57,15 +58,6 @@ uninit_initialize(struct page *page, void *kva)
 	// 페이지 초기화에 필요한 부가 정보를 담고 있는 aux 포인터를 가져옴
 	void *aux = uninit->aux;
 
-	/*	만약 페이지 타입이 mmap 또는 file-backed (VM_MMAP or VM_FILE)인 경우
-		aux에는 mmap_info 구조체가 들어 있으므로, 그 안의 info 필드를 사용함 
-	*/
-	if (uninit->type == VM_MMAP || uninit->type == VM_FILE)
-	{
-		struct mmap_info *mmap_info = (struct mmap_info *)aux;
-		aux = mmap_info->info;
-	}
-
 	/* TODO: 이 함수를 수정해야 할 수도 있습니다. */
 	return uninit->page_initializer(page, uninit->type, kva) &&
 		   (init ? init(page, aux) : true);
@@ -94,10 +86,14 @@ uninit_destroy(struct page *page)
 
 	/* auxiliary data 해제
 	 * aux는 lazy loading 등 페이지 초기화를 위해 미리 저장해둔 데이터입니다.
-	 * 예: lazy_load_segment에서 사용하는 lazy_load_info 구조체 등.
+	 * 예: lazy_load_segment에서 사용하는 구간 디스크립터(struct segment).
 	 * 
 	 * 초기화되지 않고 남은 페이지라면 이 aux도 사용되지 않았기 때문에,
 	 * 지금 해제해줘야 메모리 누수가 발생하지 않습니다.
+	 * 구간 디스크립터는 여러 페이지가 공유하므로 참조만 놓습니다.
 	 */
-	free(uninit->aux);
+	if (uninit->init == lazy_load_segment)
+		segment_put(uninit->aux);
+	else
+		free(uninit->aux);
 }
@@ -7,6 +7,126 @@
 // Project 3 : VM
 #include "kernel/hash.h"
 #include "userprog/process.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+#include "vm/vmstat.h"
+#include "vm/evict.h"
+#include "vm/swap.h"
+#include "intrinsic.h"
+#include <string.h>
+#include <stdio.h>
+#include <round.h>
+
+/* 프레임 테이블과 프레임의 역매핑 리스트를 보호합니다 */
+static struct lock frame_lock;
+/* 프레임이 unpin 될 때(교체 완료, 로딩 완료) broadcast 됩니다 */
+static struct condition frame_unpinned;
+
+/* 프레임 테이블: 유저 풀 페이지 번호로 인덱싱되는 배열 */
+static struct frame *frame_table;
+static size_t frame_cnt;
+static uint8_t *user_pool_base;
+
+/* 한 번도 쓰이지 않은 익명 페이지들이 읽기 전용으로 함께 매핑하는 0으로 채워진 프레임.
+ * 교체되지도 해제되지도 않으며, 첫 쓰기 때 vm_handle_wp가 개인 프레임을 할당합니다. */
+static struct frame *zero_frame;
+
+/* 통계 */
+static long long fault_cnt;
+static long long zero_map_cnt;   /* zero 프레임을 매핑한 횟수 */
+static long long zero_break_cnt; /* 쓰기로 zero 프레임에서 벗어난 횟수 */
+static long long cow_frame_cnt;  /* fork에서 복사 없이 함께 매핑한 프레임 수 */
+static long long cow_swap_cnt;   /* fork에서 스왑 슬롯(zswap 항목)을 물려준 페이지 수 */
+static long long cow_copy_cnt;   /* 첫 쓰기로 개인 사본을 만든 횟수 */
+static long long evict_cnt;
+static size_t frames_in_use;
+
+/* 백그라운드 회수(reclaim) 스레드.
+ * 빈 프레임 수가 low 워터마크 아래로 내려가면 깨어나서
+ * high 워터마크에 도달할 때까지 victim을 미리 내보냅니다.
+ * 0이면 vm_init()에서 유저 풀 크기에 맞춰 기본값을 정합니다.
+ * 커널 커맨드라인 옵션 "-wm-low", "-wm-high"로 조절할 수 있습니다. */
+size_t reclaim_low_wm;
+size_t reclaim_high_wm;
+static struct semaphore reclaim_sema;
+static long long reclaim_wakeups;    /* low 워터마크 도달 횟수 */
+static long long reclaim_bg_cnt;     /* 회수 스레드가 비운 프레임 수 */
+static long long reclaim_direct_cnt; /* 폴트 경로에서 동기적으로 교체한 횟수 */
+static void reclaim_thread(void *aux);
+static struct frame *frame_take(void *kva);
+
+/* 프로세스별 상주 페이지(RSS) 관리.
+ * 각 주소 공간은 프레임에 매핑된 자기 페이지 수를 세고, 상한(rss_limit)에 닿으면
+ * 폴트 때 전역 교체 대신 자기 프레임부터 내보냅니다.
+ * 빈 프레임이 없을 때는 공평한 몫(유저 풀 / 상주 페이지가 있는 프로세스 수)을 가장 많이
+ * 넘어선 프로세스의 프레임부터 내보내, 한 프로세스가 다른 프로세스들을 밀어내지 못하게 합니다.
+ * 커널 커맨드라인 옵션 "-rss-limit=PAGES"로 기본 상한을 정하고 set_rss_limit()으로 바꾸며,
+ * 상한은 fork, spawn, exec에서 그대로 이어집니다. */
+#define RSS_LIMIT_MIN 16 /* 한 명령이 필요로 하는 페이지도 못 올리는 상한은 이만큼으로 올립니다 */
+size_t rss_limit_default;
+static struct list rss_list; /* 상주 페이지가 있는 주소 공간들 (frame_lock) */
+static size_t rss_list_cnt;
+static struct supplemental_page_table *evict_owner; /* NULL이 아니면 이 주소 공간의 프레임만 victim */
+static long long rss_limit_evict_cnt; /* 상한 때문에 자기 프레임을 내보낸 횟수 */
+static long long rss_fair_evict_cnt;  /* 공평한 몫을 넘은 프로세스에서 내보낸 프레임 수 */
+
+/* cleaning 큐: 교체 정책(WSClock)이 건너뛴 dirty 프레임을 회수 스레드가 미리
+ * 기록하게 해(mmap 페이지는 파일에, 익명 페이지는 스왑에) 다음 바퀴에는 깨끗한 프레임이 되도록 합니다.
+ * victim 통계는 교체 정책과 무관하게 셉니다. */
+#define CLEAN_QUEUE_MAX 32
+static struct frame *clean_queue[CLEAN_QUEUE_MAX]; /* frame_lock이 보호 */
+static size_t clean_queue_cnt;
+static long long victim_clean_cnt;  /* I/O 없이 비울 수 있는 프레임을 고른 횟수 */
+static long long victim_dirty_cnt;  /* 깨끗한 프레임이 없어 dirty 프레임을 고른 횟수 */
+static long long clean_queue_total; /* cleaning 큐에 넣은 프레임 수 */
+static long long cleaned_page_cnt;  /* 회수 스레드가 교체 전에 미리 기록한 페이지 수 */
+static size_t frame_write_back(struct frame *frame, bool *mapped);
+static bool frame_launder_anon(struct frame *frame);
+
+/* fault-around: 파일에서 지연 로딩하는 페이지에 폴트가 나면 뒤따르는 페이지를
+ * 최대 이만큼(폴트 난 페이지 포함) 함께 읽어 매핑합니다. 1이면 끕니다.
+ * 커널 커맨드라인 옵션 "-fault-around=PAGES"로 조절할 수 있습니다. */
+#define FAULT_AROUND_MAX 16
+size_t fault_around_pages = 8;
+static long long fault_around_cnt;    /* fault-around를 시도한 폴트 수 */
+static long long fault_around_mapped; /* 폴트 없이 미리 매핑한 페이지 수 */
+
+/* 대형 페이지: 2MB 정렬된 익명 영역의 첫 폴트에서 영역 전체가 아직 올라온 적 없는
+ * zero-fill 페이지이면, 물리적으로 연속된 512개 프레임을 PDE 하나(PTE_PS)로 매핑해
+ * 폴트 수와 TLB 미스를 줄입니다. 연속된 프레임이 없으면 4KB 페이지로 처리합니다.
+ * 페이지 단위로 다뤄야 할 때(교체, 매핑 해제, fork의 COW 공유) 4KB 페이지로 쪼갭니다.
+ * 커널 커맨드라인 옵션 "-huge-pages"로 켭니다. */
+bool huge_pages;
+static long long huge_map_cnt;      /* 대형 페이지로 매핑한 2MB 영역 수 */
+static long long huge_split_cnt;    /* 4KB 페이지로 쪼갠 대형 페이지 수 */
+static long long huge_fallback_cnt; /* 연속된 프레임이 없어 4KB로 처리한 횟수 */
+
+/* 백그라운드 write-back(flusher) 스레드.
+ * 쓰기 가능한 mmap 페이지가 매핑되어 있는 동안 FLUSH_INTERVAL 틱마다 깨어나
+ * dirty한 mmap 페이지를 프레임에서 내리지 않고 파일에 기록합니다.
+ * 그러면 교체나 munmap/종료 때 몰아서 하던 기록이 시간에 걸쳐 나뉩니다.
+ * 매핑된 쓰기 가능한 mmap 페이지가 없으면 다음 매핑까지 잠듭니다(flush_armed).
+ * 커널 커맨드라인 옵션 "-flush=TICKS"로 조절하며, 0이면 끕니다. */
+size_t flush_interval = TIMER_FREQ * 5;
+static struct semaphore flush_sema;
+static bool flush_armed;              /* flusher가 주기적으로 깨어나는 중인가 (frame_lock) */
+static long long flush_pass_cnt;      /* flusher가 프레임 테이블을 훑은 횟수 */
+static long long flush_page_cnt;      /* flusher가 기록한 페이지 수 */
+static long long msync_page_cnt;      /* msync가 기록한 페이지 수 */
+static void flush_thread(void *aux);
+
+/* madvise 통계 */
+static long long willneed_cnt;    /* WILLNEED로 미리 올린 페이지 수 */
+static long long dontneed_cnt;    /* DONTNEED로 버린 페이지 수 */
+static long long drop_behind_cnt; /* SEQUENTIAL 스캔이 지나가 먼저 내보내도록 한 페이지 수 */
+
+/* 실행 코드 프레임 캐시: (inode, 파일 오프셋) -> 그 내용을 담은 프레임.
+ * 같은 실행 파일을 돌리는 프로세스들은 코드 페이지를 한 프레임에 함께 매핑하며,
+ * 프레임이 교체되거나 마지막 매핑이 사라지면 캐시에서 빠집니다. frame_lock이 보호합니다. */
+static struct hash text_cache;
+static long long text_share_cnt; /* 캐시된 프레임을 그대로 매핑한 폴트 수 */
+static uint64_t text_hash(const struct hash_elem *e, void *aux);
+static bool text_less(const struct hash_elem *a, const struct hash_elem *b, void *aux);
 
 /* 각 서브시스템의 초기화 코드를 호출하여 가상 메모리 서브시스템을 초기화합니다. */
 void vm_init(void)
@@ -19,6 +139,84 @@ void vm_init(void)
    register_inspect_intr();
    /* 이 위쪽은 수정하지 마세요 !! */
    /* TODO: 이 아래쪽부터 코드를 추가하세요 */
+   lock_init(&frame_lock);
+   cond_init(&frame_unpinned);
+   hash_init(&text_cache, text_hash, text_less, NULL);
+   list_init(&rss_list);
+   if (rss_limit_default > 0 && rss_limit_default < RSS_LIMIT_MIN)
+      rss_limit_default = RSS_LIMIT_MIN;
+
+   /* 유저 풀 전체에 대한 프레임 디스크립터를 한 번에 할당합니다.
+    * 이후 폴트 경로에서는 힙 할당이 일어나지 않습니다. */
+   palloc_user_pool_info((void **)&user_pool_base, &frame_cnt);
+   frame_table = palloc_get_multiple(PAL_ASSERT | PAL_ZERO,
+                                     DIV_ROUND_UP(frame_cnt * sizeof(struct frame), PGSIZE));
+   for (size_t i = 0; i < frame_cnt; i++)
+   {
+      struct frame *frame = &frame_table[i];
+      frame->kva = user_pool_base + i * PGSIZE;
+      list_init(&frame->mappings);
+   }
+
+   evict_init(frame_table, frame_cnt);
+   zero_frame = frame_take(palloc_get_page(PAL_ASSERT | PAL_USER | PAL_ZERO));
+   zero_frame->pinned = false;
+   evict_remove(zero_frame);
+
+   if (reclaim_low_wm == 0)
+      reclaim_low_wm = frame_cnt / 32 > 4 ? frame_cnt / 32 : 4;
+   if (reclaim_high_wm <= reclaim_low_wm)
+      reclaim_high_wm = reclaim_low_wm * 2;
+   if (reclaim_high_wm > frame_cnt / 2)
+      reclaim_high_wm = frame_cnt / 2;
+   sema_init(&reclaim_sema, 0);
+   thread_create("reclaimd", PRI_DEFAULT, reclaim_thread, NULL);
+   sema_init(&flush_sema, 0);
+   if (flush_interval > 0)
+      thread_create("flushd", PRI_DEFAULT, flush_thread, NULL);
+}
+
+/* 유저 풀 페이지 KVA에 해당하는 프레임 디스크립터를 반환합니다. */
+struct frame *
+frame_from_kva(void *kva)
+{
+   size_t idx = pg_no(kva) - pg_no(user_pool_base);
+
+   ASSERT(pg_ofs(kva) == 0);
+   ASSERT(idx < frame_cnt);
+   return &frame_table[idx];
+}
+
+/* VM 통계를 출력합니다. */
+void vm_print_stats(void)
+{
+   printf("VM: %lld faults, %lld evictions, %zu of %zu frames in use\n",
+          fault_cnt, evict_cnt, frames_in_use, frame_cnt);
+   printf("Fault-around: %lld pages mapped ahead in %lld faults (window %zu)\n",
+          fault_around_mapped, fault_around_cnt, fault_around_pages);
+   printf("Text sharing: %lld faults mapped a cached frame, %zu frames cached\n",
+          text_share_cnt, hash_size(&text_cache));
+   printf("Zero page: %lld mappings, %lld broken by writes\n",
+          zero_map_cnt, zero_break_cnt);
+   printf("COW: %lld frames and %lld swapped pages shared at fork, %lld copies on write\n",
+          cow_frame_cnt, cow_swap_cnt, cow_copy_cnt);
+   printf("Huge pages: %lld mapped, %lld split, %lld fell back to 4KB pages\n",
+          huge_map_cnt, huge_split_cnt, huge_fallback_cnt);
+   printf("madvise: %lld pages prefetched, %lld dropped, %lld aged behind sequential scans\n",
+          willneed_cnt, dontneed_cnt, drop_behind_cnt);
+   printf("Writeback: %lld pages by msync, %lld by flusher in %lld passes (interval %zu ticks)\n",
+          msync_page_cnt, flush_page_cnt, flush_pass_cnt, flush_interval);
+   printf("Eviction (%s): %lld clean victims, %lld dirty victims, %lld frames queued for cleaning, "
+          "%lld pages cleaned\n",
+          evict_policy_name(), victim_clean_cnt, victim_dirty_cnt, clean_queue_total, cleaned_page_cnt);
+   printf("RSS: %lld frames evicted by per-process limits, %lld from processes above their fair share\n",
+          rss_limit_evict_cnt, rss_fair_evict_cnt);
+   printf("Reclaim: %lld low watermark hits, %lld background, %lld direct "
+          "(watermarks %zu/%zu)\n",
+          reclaim_wakeups, reclaim_bg_cnt, reclaim_direct_cnt,
+          reclaim_low_wm, reclaim_high_wm);
+   anon_print_stats();
+   vmstat_print();
 }
 
 /* 페이지의 타입을 가져옵니다. 이 함수는 페이지가 초기화된 후 타입을 알고 싶을 때 유용합니다.
@@ -37,13 +235,14 @@ page_get_type(struct page *page)
 }
 
 /* Helpers */
-static void hash_spt_entry_kill(struct hash_elem *e, void *aux);
+static void hash_spt_page_kill(struct hash_elem *e, void *aux);
 static struct frame *vm_get_victim(void);
 static bool vm_do_claim_page(struct page *page);
-static struct frame *vm_evict_frame(void);
+static size_t vm_evict_frames(struct frame *victims[], size_t max,
+                              struct supplemental_page_table *spt);
+static struct segment *page_segment(struct page *page);
 static uint64_t my_hash(const struct hash_elem *e, void *aux UNUSED);
 static bool my_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED);
-static struct list_elem *clock_start;
 
 /* 이 함수는 가상 주소(upage)에 해당하는 '페이지 객체'를 생성하고,
    초기화 함수(init)와 보조 데이터(aux)를 등록
@@ -85,6 +284,9 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
       case VM_FILE:
          page_initializer = file_backed_initializer;  // 파일 기반 메모리
          break;
+      case VM_TEXT:
+         page_initializer = text_initializer;         // 읽기 전용 실행 코드
+         break;
       default:
          free(page);                                  // 지원하지 않는 타입이면 메모리 해제 후 에러 처리
          goto err;
@@ -119,17 +321,15 @@ err:
 struct page *
 spt_find_page(struct supplemental_page_table *spt UNUSED, void *va UNUSED)
 {
-   // 더미 SPT_entry를 생성하여 va 값 기반 hash 조회
+   /* va만 채운 더미 page를 키로 조회합니다. SPT 엘리먼트가 page에 들어 있으므로
+    * 찾은 엘리먼트에서 바로 page를 얻습니다 */
    struct page *finding_page = NULL;
-   struct SPT_entry lookup;
+   struct page lookup;
    lookup.va = pg_round_down(va);
 
-   // 인자는 더미 SPT_entry, 반환된 finding_hash_elem은 실제 SPT_entry 소속 hash_elem
-   struct hash_elem *finding_hash_elem = hash_find(&spt->SPT_hash_list, &lookup.elem);
-
-   // 탐색 성공 시, hash_elem로 entry 조회, page 확보
+   struct hash_elem *finding_hash_elem = hash_find(&spt->SPT_hash_list, &lookup.spt_elem);
    if (finding_hash_elem != NULL)
-      finding_page = hash_entry(finding_hash_elem, struct SPT_entry, elem)->page;
+      finding_page = hash_entry(finding_hash_elem, struct page, spt_elem);
 
    return finding_page;
 }
@@ -147,412 +347,1876 @@ bool spt_insert_page(struct supplemental_page_table *spt UNUSED,
       return false;
    }
 
-   // 메모리 할당
-   struct SPT_entry *entry = malloc(sizeof(struct SPT_entry));
-   // 예외 처리
-   if (entry == NULL)
-   {
-      return false;
-   }
-
-   entry->va = page->va; // 가상 주소 : page 구조체의 va 필드 -> SPT_entry의 va 필드
-   entry->page = page;   // 페이지 참조 : page 구조체의 주소 -> SPT_entry의 page 포인터
-
-   if (hash_insert(&spt->SPT_hash_list, &entry->elem) != NULL)
-   {
-      // 삽입 실패시 메모리 정리
-      free(entry);
-      return false; // 삽입 실패
-   }
+   if (hash_insert(&spt->SPT_hash_list, &page->spt_elem) != NULL)
+      return false; // 같은 va의 페이지가 이미 있음
+   page->spt = spt;
 
    return true; // SPT 페이지 삽입 성공
 }
 
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
 {
-   struct SPT_entry lookup;
-   /* 내가 찾을 페이지의 가상 주소를 넣습니다 */
-   lookup.va = page->va;
-   /* SPT_hash_list에서 해당 가상 주소를 가진 엔트리를 제거합니다 */
-   struct hash_elem *delete_elem = hash_delete(&spt->SPT_hash_list, &lookup.elem);
-   if (delete_elem == NULL)
-   {
+   /* SPT_hash_list에서 페이지를 뺍니다 */
+   if (hash_delete(&spt->SPT_hash_list, &page->spt_elem) == NULL)
       return;
-   }
-   struct SPT_entry *deleted = hash_entry(delete_elem, struct SPT_entry, elem);
 
-   /* 페이지 테이블에서 해당 가상 페이지 삭제 */
-   pml4_clear_page(thread_current()->pml4, page->va);
+   /* 페이지 테이블 매핑은 vm_dealloc_page가 역매핑과 함께 해제합니다 */
    vm_dealloc_page(page);
-   /** TODO: page 해제
-    * 매핑된 프레임을 해제해야하나?
-    * 프레임이 스왑되어있는지 체크할것?
-    * 아마 pml4_clear_page 사용하면 된대요
-    */
-
-   /* 내부 페이지의 요소가 모두 free 된 이후 SPT_entry free */
-   free(deleted);
-   return true;
 }
 
-static struct frame *vm_get_victim(void)
+/* 캐시된 PTE를 고친 뒤 그 페이지의 TLB 엔트리를 무효화합니다.
+ * 다른 프로세스의 페이지 테이블이면 다음에 활성화될 때 비워집니다. */
+static void
+page_flush_tlb(struct page *page)
+{
+   pml4_invalidate_page(page->pml4, page->va);
+}
+
+/* PAGE의 PTE에 dirty 비트가 켜져 있으면 true를 반환합니다.
+ * 프레임에 매핑되어 있지 않은 페이지는 항상 false 입니다. */
+bool page_is_dirty(struct page *page)
 {
-   struct list_elem *clock_now;
-   struct frame *victim;
+   return page->frame != NULL && page->pte != NULL && (*page->pte & PTE_D) != 0;
+}
 
-   ASSERT(victim != NULL);
-   if(clock_start == NULL || clock_start == list_end(&frame_table))
-      clock_start = list_begin(&frame_table);
+/* PAGE의 PTE dirty 비트를 DIRTY로 설정합니다. */
+void page_set_dirty(struct page *page, bool dirty)
+{
+   if (page->frame == NULL || page->pte == NULL)
+      return;
+   if (dirty)
+      *page->pte |= PTE_D;
+   else
+      *page->pte &= ~(uint64_t)PTE_D;
+   page_flush_tlb(page);
+}
 
-   clock_now = clock_start;
-   do{
-      victim = list_entry(clock_now,struct frame, elem);
+/* FRAME을 매핑한 모든 페이지의 accessed 비트를 검사하고 지웁니다.
+ * 하나라도 접근된 적이 있으면 true를 반환합니다. */
+bool
+frame_test_and_clear_accessed(struct frame *frame)
+{
+   bool accessed = false;
+   struct list_elem *e;
 
-      bool success = pml4_is_accessed(thread_current()->pml4,victim->page->va);
-      if(success == false){
-         clock_start = list_next(clock_now);
-         return victim;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if (*page->pte & PTE_A)
+      {
+         accessed = true;
+         *page->pte &= ~(uint64_t)PTE_A;
+         page_flush_tlb(page);
       }
+   }
+   return accessed;
+}
 
+static uint64_t
+text_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+   const struct frame *frame = hash_entry(e, struct frame, text_elem);
+   return hash_bytes(&frame->text_inode, sizeof frame->text_inode) ^ hash_int(frame->text_ofs);
+}
 
-      pml4_set_accessed(thread_current()->pml4,victim->page->va, false);
-      clock_now = list_next(clock_now);
-      if(clock_now == list_end(&frame_table))
-         clock_now = list_begin(&frame_table);
-   } while(clock_now != clock_start);
-
-   victim = list_entry(clock_now,struct frame, elem);
-   clock_start = list_next(clock_now);
+static bool
+text_less(const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED)
+{
+   const struct frame *a = hash_entry(a_, struct frame, text_elem);
+   const struct frame *b = hash_entry(b_, struct frame, text_elem);
+   if (a->text_inode != b->text_inode)
+      return a->text_inode < b->text_inode;
+   return a->text_ofs < b->text_ofs;
+}
 
-   return victim;
+/* PAGE가 실행 코드 페이지이면 그 내용의 위치(inode, 파일 오프셋)를 INODE, OFS에 담고
+ * true를 반환합니다. 아직 올라온 적 없는 uninit 페이지도 해당합니다. */
+static bool
+page_text_key(struct page *page, struct inode **inode, off_t *ofs)
+{
+   if (page->operations->type == VM_TEXT)
+   {
+      *inode = file_get_inode(page->file.file);
+      *ofs = page->file.offset;
+      return true;
+   }
+   if (page->operations->type == VM_UNINIT && page->uninit.type == VM_TEXT)
+   {
+      struct segment *seg = page->uninit.aux;
+      *inode = file_get_inode(seg->file);
+      *ofs = segment_page_offset(seg, page->va);
+      return true;
+   }
+   return false;
 }
 
-/* 한 페이지를 교체(evict)하고 해당 프레임을 반환합니다.
- * 에러가 발생하면 NULL을 반환합니다.*/
+/* 실행 코드 페이지 PAGE의 내용을 담은 프레임이 캐시에 있으면 반환합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
 static struct frame *
-vm_evict_frame(void)
+text_cache_find(struct page *page)
 {
-   struct frame *victim = vm_get_victim();
-   if (victim == NULL)
-      return NULL;
-   /* TODO: swap out the victim and return the evicted frame. */
+   struct frame key;
+   struct hash_elem *e;
 
-   struct page *victim_page = victim->page;
-   if (victim_page == NULL)
+   if (!page_text_key(page, &key.text_inode, &key.text_ofs))
       return NULL;
-   /** TODO: 여기서 swap_out 매크로를 호출??
-    *   pml4_clear_page를 아마 사용?? (잘 모름)
-    */
-
-   if (!swap_out(victim_page))
-      return NULL;
-   pml4_clear_page(thread_current()->pml4, victim_page->va);
-   list_remove(&victim->elem);
-
-   return victim;
+   e = hash_find(&text_cache, &key.text_elem);
+   return e != NULL ? hash_entry(e, struct frame, text_elem) : NULL;
 }
 
-/* palloc()을 사용하여 프레임을 할당합니다.
- * 사용 가능한 페이지가 없으면 페이지를 교체(evict)하여 반환합니다.
- * 이 함수는 항상 유효한 주소를 반환합니다. 즉, 사용자 풀 메모리가 가득 차면,
- * 이 함수는 프레임을 교체하여 사용 가능한 메모리 공간을 확보합니다.*/
-static struct frame *
-vm_get_frame(void)
-{ 
-   /* 1. 새로운 frame 구조체를 메모리에 할당
-      이는 물리 페이지의 메타데이터를 저장할 공간
-      반드시 free해라 뒤지기싫으면.. 
-   */
-   struct frame *frame = malloc(sizeof(struct frame));
-   // 예외 처리 → 할당 실패시 시스템 중단
-   ASSERT(frame != NULL);  
-
-   /* 2. 실제 물리 페이지(4KB) 할당 시도 
-      PAL_USER : 사용자 프로세스용 메모리 풀에서 할당
-      PAL_ZERO : 할당된 페이지를 0으로 초기화
-   */
-   frame->kva = palloc_get_page(PAL_USER | PAL_ZERO);
-
-   /* 3. 메모리 부족 상황 처리
-      사용 가능한 물리 페이지가 없는 경우 처리
-   */
-   if (frame->kva == NULL)
-   {  
-      /* 3.1. 희생자(victim) 프레인 선택 및 교체
-         vm_evict_frame()은 페이지 교체 알고리즘(처음: FIFO, 지금: Clock)을 사용하여
-         교체할 프레임을 선택, 해당 페이지를 디스코로 내보냅니다.
-      */
-      struct frame *victim1 = vm_evict_frame();
-
-      // 예외 처리 → 교체 실패시 시스템 중단
-      ASSERT(victim1 != NULL);
-
-      /* 3.2. 희생자의 물리 페이지를 재활용
-         교체된 프레임의 물리 주소를 새로운 프레임이 사용
-      */
-      frame->kva = victim1->kva; // victim의 물리 페이지를 재활용
-
-      /* 3.3. 희생자 프레임 구조체 해제
-         물리 페이지는 재활용하지만, 메타데이터는 새로 만듦
-      */
-      free(victim1);
-   }
-
-   /* 4. 새로운 프레임 초기화
-      아직 어떤 가상 페이지와도 연결되지 않은 상태
-   */
-   frame->page = NULL;                 // 연결된 가상 페이지 X
-   frame->ref_cnt = 1;                 // 참조 카운터 초기화(COW extra 과제 용)
-   
-   /* 5. 프레임 테이블에 등록
-      시스템이 이 프레임을 추적할 수 있도록 전역 프레임 테이블에 추가
-   */
-   frame_table_insert(&frame->elem);   
-
-   /* 예외 처리 → 프레임이 올바르게 초기화 되었나? */
-   ASSERT(frame->page == NULL);
-
-   /* 6. 할당된 프레임 반환
-      이제 이 프레임은 가상 페이지와 연결된 준비가 완료되었습니다.
-   */
-   return frame;
+/* 실행 코드 페이지 PAGE를 처음 담는 FRAME을 캐시에 등록합니다.
+ * 실행 코드 페이지가 아니거나 같은 내용의 프레임이 이미 있으면 아무것도 하지 않습니다. */
+static void
+text_cache_insert(struct frame *frame, struct page *page)
+{
+   if (frame->text_inode != NULL || !page_text_key(page, &frame->text_inode, &frame->text_ofs))
+      return;
+   if (hash_insert(&text_cache, &frame->text_elem) != NULL)
+      frame->text_inode = NULL;
 }
 
-/* Growing the stack. */
+/* FRAME이 캐시에 있으면 뺍니다. 내용을 잃거나 다른 용도로 쓰이기 전에 불러야 합니다. */
 static void
-vm_stack_growth(void *addr UNUSED)
+text_cache_remove(struct frame *frame)
 {
-   /* 스택 최하단에 익명 페이지를 추가하여 사용
-    * addr은 PGSIZE로 내림(정렬)하여 사용    */
-   vm_alloc_page(VM_ANON, addr, true); // 스택 최하단에 익명 페이지 추가
-   vm_claim_page(addr);
+   if (frame->text_inode == NULL)
+      return;
+   hash_delete(&text_cache, &frame->text_elem);
+   frame->text_inode = NULL;
 }
 
-/* Handle the fault on write_protected page */
+/* PAGE가 mmap한 파일 페이지(아직 올라오기 전인 uninit 포함)이면 true */
 static bool
-vm_handle_wp(struct page *page UNUSED)
+page_is_mmap(struct page *page)
 {
-   if (page == NULL)
-   {
-      return false;
-   }
-   struct frame *copy_frame = page->frame;
+   enum vm_type type = page_get_type(page);
+   return type == VM_FILE || type == VM_MMAP;
+}
 
-   if (copy_frame->ref_cnt > 1)
-   {
-      struct frame *frame = vm_get_frame();
-      page->frame = frame;
-      memcpy(frame->kva, copy_frame->kva, PGSIZE);
-      copy_frame->ref_cnt--;
+/* PAGE가 FRAME에 매핑되었거나(MAPPED) 매핑이 풀렸을 때 주소 공간의 상주 페이지 수를 고칩니다.
+ * 모두가 함께 쓰는 zero 프레임은 세지 않습니다. */
+static void
+rss_account(struct page *page, struct frame *frame, bool mapped)
+{
+   struct supplemental_page_table *spt = page->spt;
 
-      if (!pml4_set_page(thread_current()->pml4, page->va, frame->kva, true))
-         return false;
+   if (frame == zero_frame)
+      return;
+   if (mapped)
+   {
+      if (spt->rss++ == 0)
+      {
+         list_push_back(&rss_list, &spt->rss_elem);
+         rss_list_cnt++;
+      }
    }
    else
    {
-      copy_frame->page = page;
-      if (!pml4_set_page(thread_current()->pml4, page->va, copy_frame->kva, true))
-         return false;
+      ASSERT(spt->rss > 0);
+      if (--spt->rss == 0)
+      {
+         list_remove(&spt->rss_elem);
+         rss_list_cnt--;
+      }
    }
-
-   return true;
 }
 
-/* Return true on success */
-/* bogus 폴트인지? 스택확장 폴트인지?
- * SPT 뒤져서 존재하면 bogus 폴트!!
- * addr이 유저 스택 시작 주소 + 1MB를 넘지 않으면 스택확장 폴트
- * 찐폴트면 false 리턴
- * 아니면 vm_do_claim_page 호출
- * 스택확장 폴트에서 valid를 확인하려면 유저 스택 시작 주소 + 1MB를 넘는지 확인
- * addr = thread 내의 user_rsp
- * addr은 user_rsp보다 크면 안됨
- * stack_growth 호출해야함 */
-bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
-                         bool user UNUSED, bool write UNUSED, bool not_present UNUSED)
+/* SPT가 상한에 닿아 페이지를 더 올릴 수 없으면 true를 반환합니다. */
+static bool
+rss_full(struct supplemental_page_table *spt)
 {
-   struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
-   addr = pg_round_down(addr);
+   return spt->rss_limit > 0 && spt->rss >= spt->rss_limit;
+}
 
-   uintptr_t rsp = thread_current()->user_rsp; // 유저 스택의 rsp 가져오기
+/* 이미 설치된 PML4의 엔트리 PTE로 PAGE가 FRAME에 매핑되었음을 역매핑에 기록합니다. */
+static void
+frame_link_page(struct frame *frame, struct page *page, uint64_t *pml4, uint64_t *pte)
+{
+   page->pml4 = pml4;
+   page->pte = pte;
+   page->frame = frame;
+   list_push_back(&frame->mappings, &page->map_elem);
+   frame->ref_cnt++;
+   rss_account(page, frame, true);
+   evict_mapped(frame, page);
 
-   struct page *page = spt_find_page(spt, addr);
-   // if (page == NULL)
-   // {
-   //    return false;
-   // }
-   // 찐 폴트
-   if (page == NULL && (uintptr_t)addr >= rsp - STACK_GROW_RANGE && addr < USER_STACK && addr >= USER_STACK - (1 << 20))
-   {
-      vm_stack_growth(addr);
-      return true;
+   /* 쓰기 가능한 mmap 페이지가 올라오면 잠들어 있던 flusher를 깨웁니다 */
+   if (page->writable && !flush_armed && flush_interval > 0 && page_is_mmap(page))
+   {
+      flush_armed = true;
+      sema_up(&flush_sema);
    }
+}
 
-   if (page == NULL)
-      return false;
+/* PAGE를 FRAME에 매핑하고 FRAME의 역매핑 리스트에 등록합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static bool
+frame_map_page(struct frame *frame, struct page *page, bool writable)
+{
+   uint64_t *pml4 = thread_current()->pml4;
 
-   if (write == true && !page->writable)
-      return false;
+   ASSERT(lock_held_by_current_thread(&frame_lock));
 
-   if (write == true && page->writable && page->frame != NULL)
-      return vm_handle_wp(page);
+   if (!pml4_set_page(pml4, page->va, frame->kva, writable))
+      return false;
 
-   ASSERT(page->operations != NULL && page->operations->swap_in != NULL);
+   frame_link_page(frame, page, pml4, pml4e_walk(pml4, (uint64_t)page->va, false));
+   /* 실행 코드를 처음 담는 프레임이면 다른 프로세스가 찾을 수 있게 등록합니다 */
+   text_cache_insert(frame, page);
+   return true;
+}
 
-   return vm_do_claim_page(page);
+/* 대형 페이지에 속한 FRAME이 들어 있는 512개 프레임 묶음의 첫 프레임을 반환합니다. */
+static struct frame *
+frame_huge_head(struct frame *frame)
+{
+   return frame_from_kva((void *)((uintptr_t)frame->kva & ~(HUGE_PGSIZE - 1)));
 }
 
-/* Free the page.
- * DO NOT MODIFY THIS FUNCTION. */
-void vm_dealloc_page(struct page *page)
+/* FRAME이 속한 대형 페이지를 4KB 페이지 512개로 쪼개고, 각 페이지의 캐시된 PTE를
+ * 새 페이지 테이블의 엔트리로 옮깁니다. 권한과 accessed/dirty 비트는 그대로 이어집니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static void
+frame_split_huge(struct frame *frame)
 {
-   if (page->frame)
-      page->frame->ref_cnt--;
+   struct frame *head = frame_huge_head(frame);
+   struct page *first = list_entry(list_front(&head->mappings), struct page, map_elem);
+   uint64_t *pt = head->huge_pt;
 
-   destroy(page);
-   free(page);
-}
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+   ASSERT(head->huge && pt != NULL);
 
-/* VA에 할당된 페이지를 요구합니다. 
-   이 함수는 Page Fault 발생 시 호출되어 가상 페이지를 물리 메모리에 로드합니다.    
-*/
-bool vm_claim_page(void *va UNUSED)
-{  
-   /* 1. 가상 주소로 SPT에서 해당 페이지 구조체 찾기 */
-   struct page *page = spt_find_page(&thread_current()->spt,   // 현재 스레드의 보조 페이지 테이블
-                                     va);                      // 요청된 가상 주소(e.g. 0x400000000(예시임 너무 신경 ㄴㄴ), 스택 주소, 힙 주소 등등)
-   /* 2. 예외 처리 → 페이지 존재 여부 검증
-      page == NULL인 case :
-      - 할당되지 않은 메모리 영역에 접근 (segmentation fault 상황)
-      - 잘못된 가상 주소 접근 
-      - 아직 vm_alloc_page로 생성되지 않은 페이지
-   */
-   if (page == NULL) 
+   pml4_split_huge_page(first->pml4, first->va, pt);
+   for (size_t i = 0; i < HUGE_PGCNT; i++)
    {
-      return false;  // 실패 : 유효하지 않은 페이지 요청
+      struct frame *f = &head[i];
+      struct page *page = list_entry(list_front(&f->mappings), struct page, map_elem);
+      ASSERT(f->huge && list_size(&f->mappings) == 1);
+      page->pte = &pt[i];
+      f->huge = false;
    }
-
-   /* 3. 실제 페이지 클레임 수행*/
-   return vm_do_claim_page(page);
+   /* 페이지 테이블은 이제 pml4 소유이므로 비게 되거나 pml4_destroy 때 해제됩니다 */
+   head->huge_pt = NULL;
+   huge_split_cnt++;
 }
 
-/* PAGE를 요구하고 mmu를 설정합니다.*/
-static bool
-vm_do_claim_page(struct page *page)
-{  
-   // 1. 물리 프레임 할당
-   struct frame *frame = vm_get_frame();
+/* PAGE의 매핑을 해제하고 역매핑 리스트에서 제거합니다.
+ * PTE를 통째로 지우므로 dirty/accessed 비트가 필요하면 그 전에 읽어야 하며,
+ * 그 결과 빈 페이지 테이블은 pml4_clear_page가 해제합니다. 프레임 자체는 해제하지 않습니다. */
+static void
+frame_unmap_page(struct page *page)
+{
+   struct frame *frame = page->frame;
+
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+   ASSERT(frame != NULL);
+
+   /* 대형 페이지의 PDE를 지우면 나머지 511개 페이지도 사라지므로 먼저 쪼갭니다 */
+   if (frame->huge)
+      frame_split_huge(frame);
+   pml4_clear_page(page->pml4, page->va);
+   list_remove(&page->map_elem);
+   frame->ref_cnt--;
+   rss_account(page, frame, false);
+   page->frame = NULL;
+   page->pte = NULL;
+}
 
-   /* Set links */
-   /* 2. 양방향 링크 설정 (페이지 ↔ 프레임 연결)
-      가상 페이지와 물리 프레임 간의 관계를 설정
-   */
-   frame->page = page;
-   page->frame = frame;
+/* FRAME의 pin을 풀고, 교체나 로딩이 끝나기를 기다리는 스레드를 깨웁니다. */
+static void
+frame_unpin(struct frame *frame)
+{
+   bool held = lock_held_by_current_thread(&frame_lock);
+
+   if (!held)
+      lock_acquire(&frame_lock);
+   frame->pinned = false;
+   cond_broadcast(&frame_unpinned, &frame_lock);
+   if (!held)
+      lock_release(&frame_lock);
+}
 
-   /* TODO: Insert page table entry to map page's VA to frame's PA. */
-   // 3. 페이지 테이블 엔트리 설정(MMU 매핑)
-   if (!pml4_set_page(thread_current()->pml4,   // 현재 스레드 페이지 테이블
-       page->va,                                // 가상 주소
-       frame->kva,                              // 물리 주소 (커널 가상 주소)
-       page->writable))                         // 쓰기 권한
-   {                        
-   /* 매핑 실패 처리
-      실패 case : 
-      - 메모리 부족
-      - 이미 매핑된 주소
-      - 잘못된 권한 
-      등등 더 자세한 설명은 생략한다. 디버깅해서 찾아보슈
-   */
-      return false;
-   }
+/* PAGE가 매핑된 프레임을 다른 스레드가 교체 중이면 끝날 때까지 기다립니다.
+ * 돌아온 뒤 page->frame이 NULL이면 교체가 끝나 페이지가 내려간 것입니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static void
+wait_for_eviction(struct page *page)
+{
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+   while (page->frame != NULL && page->frame->pinned)
+      cond_wait(&frame_unpinned, &frame_lock);
+}
 
-   // 4. 실제 페이지 내용 로딩
-   return swap_in(page, frame->kva);
+/* 아무도 매핑하지 않는 FRAME을 사용 해제하고 물리 페이지를 반환합니다. */
+static void
+frame_free(struct frame *frame)
+{
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+   ASSERT(list_empty(&frame->mappings));
+
+   text_cache_remove(frame);
+   evict_remove(frame);
+   frame->in_use = false;
+   frames_in_use--;
+   palloc_free_page(frame->kva);
 }
 
-bool vm_copy_claim_page(void *va, struct page *parent, struct supplemental_page_table *parent_spt)
+/* 익명 페이지를 담은 FRAME이 swap-in 뒤로 쓰인 적이 없으면, 그 내용과 같은 사본을
+ * 스왑 슬롯에 가지고 있는 페이지를 반환합니다. 그런 페이지가 없으면 NULL.
+ * 어느 매핑으로든 쓰였다면 dirty 비트가 켜져 있으므로 모든 매핑을 확인합니다. */
+static struct page *
+frame_swap_backed_page(struct frame *frame)
 {
-   struct page *page = spt_find_page(&thread_current()->spt, va); // 스택 첫번째페이지
-   if (page == NULL)
-      return false;
+   struct page *backed = NULL;
+   struct list_elem *e;
 
-   void *temp = page->operations->swap_in;
-   struct frame *frame = parent->frame;
-   frame->ref_cnt++;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if (page_is_dirty(page))
+         return NULL;
+      if (backed == NULL && page->operations->type == VM_ANON && page->anon.swap_idx >= 0)
+         backed = page;
+   }
+   return backed;
+}
 
-   if (frame->ref_cnt == 1)
-      return true;
+/* FRAME을 I/O 없이 비울 수 있으면 true를 반환합니다.
+ * 실행 코드와 dirty 비트가 꺼진 mmap 페이지는 파일에서 다시 읽으면 되고,
+ * 익명 페이지는 swap-in 뒤로 쓰이지 않아 스왑 슬롯의 사본이 그대로 유효할 때만 깨끗합니다. */
+bool
+frame_is_clean(struct frame *frame)
+{
+   bool anon = false;
+   struct list_elem *e;
 
-   /* Set links */
-   page->frame = frame;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if (page_is_dirty(page))
+         return false;
+      if (page->operations->type == VM_ANON)
+         anon = true;
+   }
+   return !anon || frame_swap_backed_page(frame) != NULL;
+}
 
-   /* TODO: Insert page table entry to map page's VA to frame's PA. */
-   if (!pml4_set_page(thread_current()->pml4, page->va, frame->kva, false))
-      return false;
+/* 깨끗하지 않은 FRAME을 회수 스레드가 미리 기록하도록 cleaning 큐에 넣습니다.
+ * 대형 페이지와, 스왑이 반 이상 차 있을 때의 익명 프레임은 넣지 않습니다.
+ * 큐가 차 있으면 넣지 않습니다. frame_lock을 보유한 상태에서 호출해야 합니다. */
+void
+frame_queue_clean(struct frame *frame)
+{
+   struct list_elem *e;
 
-   return swap_in(page, frame->kva);
+   if (frame->clean_queued || clean_queue_cnt == CLEAN_QUEUE_MAX || frame->huge ||
+       frame_is_clean(frame))
+      return;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if ((page->operations->type == VM_FILE && page_is_dirty(page)) ||
+          (page->operations->type == VM_ANON && !swap_full()))
+      {
+         frame->clean_queued = true;
+         clean_queue[clean_queue_cnt++] = frame;
+         clean_queue_total++;
+         if (clean_queue_cnt == 1)
+            sema_up(&reclaim_sema);
+         return;
+      }
+   }
 }
 
-/* Initialize new supplemental page table */
-void supplemental_page_table_init(struct supplemental_page_table *spt UNUSED)
+/* FRAME을 SPT의 페이지가 매핑하고 있으면 true를 반환합니다. */
+static bool
+frame_mapped_by(struct frame *frame, struct supplemental_page_table *spt)
 {
-   if (!hash_init(&spt->SPT_hash_list, my_hash, my_less, NULL))
-      return;
+   struct list_elem *e;
+
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+      if (list_entry(e, struct page, map_elem)->spt == spt)
+         return true;
+   return false;
 }
 
-static uint64_t my_hash(const struct hash_elem *e, void *aux UNUSED)
+/* 교체 정책이 victim으로 고를 수 있는 프레임이면 true를 반환합니다.
+ * 대형 페이지는 accessed 비트가 PDE 하나뿐이므로 첫 프레임만 후보가 되며,
+ * 내보낼 때 쪼개서 4KB 페이지처럼 다룹니다.
+ * 한 프로세스의 프레임만 내보내는 중이면(evict_owner) 그 프로세스가 매핑한 프레임만 후보입니다. */
+bool
+frame_evictable(struct frame *frame)
 {
-   struct SPT_entry *entry = hash_entry(e, struct SPT_entry, elem);
-   return hash_int((uint64_t)entry->va);
+   return frame->in_use && !frame->pinned && !list_empty(&frame->mappings) &&
+          frame != zero_frame && (!frame->huge || frame == frame_huge_head(frame)) &&
+          (evict_owner == NULL || frame_mapped_by(frame, evict_owner));
 }
 
-static bool my_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+/* 교체 정책(vm/evict.c)으로 교체할 프레임을 고릅니다.
+ * 역매핑을 따라 프레임을 매핑한 모든 프로세스의 accessed 비트를 확인하므로
+ * 다른 프로세스 소유의 프레임도 올바르게 aging 됩니다. */
+static struct frame *vm_get_victim(void)
 {
-   if (a == NULL)
-      return true;
-   if (b == NULL)
-      return false;
-   struct SPT_entry *a_entry = hash_entry(a, struct SPT_entry, elem);
-   struct SPT_entry *b_entry = hash_entry(b, struct SPT_entry, elem);
-   return a_entry->va < b_entry->va;
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   struct frame *victim = evict_select();
+   if (victim == NULL)
+      return NULL;
+   ASSERT(frame_evictable(victim));
+   if (victim->huge)
+      frame_split_huge(victim);
+   if (frame_is_clean(victim))
+      victim_clean_cnt++;
+   else
+      victim_dirty_cnt++;
+   return victim;
 }
 
-static void *duplicate_aux(struct page *src_page)
+/* 교체 통계에서 PAGE를 셀 타입 */
+static enum vmstat_evict
+page_evict_type(struct page *page)
 {
-   if (src_page->uninit.type == VM_MMAP)
+   switch (page->operations->type)
    {
-      struct mmap_info *src_mmap_info = (struct mmap_info *)src_page->uninit.aux;
-      struct lazy_load_info *src_info = (struct lazy_load_info *)src_mmap_info->info;
-
-      struct mmap_info *dst_mmap_info = malloc(sizeof(struct mmap_info));
-      struct lazy_load_info *dst_info = malloc(sizeof(struct lazy_load_info));
+   case VM_ANON:
+      return VMSTAT_EVICT_ANON;
+   case VM_TEXT:
+      return VMSTAT_EVICT_TEXT;
+   default:
+      return VMSTAT_EVICT_FILE;
+   }
+}
 
-      dst_info->file = file_reopen(src_info->file);
-      dst_info->offset = src_info->offset;
-      dst_info->readbyte = src_info->readbyte;
-      dst_info->zerobyte = src_info->zerobyte;
+/* 교체 묶음 안에서 페이지를 (주소 공간, 가상 주소) 순으로 비교합니다. */
+static bool
+page_addr_less(const struct page *a, const struct page *b)
+{
+   if (a->pml4 != b->pml4)
+      return a->pml4 < b->pml4;
+   return a->va < b->va;
+}
 
-      dst_mmap_info->mapping_count = src_mmap_info->mapping_count;
-      dst_mmap_info->info = dst_info;
+/* 최대 MAX개(SWAP_CLUSTER 이하)의 victim 프레임을 골라 한꺼번에 교체(evict)하고
+ * VICTIMS에 담아 그 개수를 반환합니다. 교체할 프레임이 없으면 0을 반환합니다.
+ * SPT가 NULL이 아니면 그 주소 공간이 매핑한 프레임 중에서만 고릅니다.
+ * 프레임을 공유하는 모든 페이지(COW 공유자 포함)를 함께 내보냅니다.
+ * 한 프레임을 함께 쓰던 익명 페이지들은 한 벌만 기록하고 그 스왑 슬롯을 함께 가리킵니다.
+ * 익명 페이지들은 주소 순으로 정렬해 연속된 스왑 슬롯에 한 번의 디스크 명령으로
+ * 기록하므로, 나중에 swap-in 할 때 이웃 페이지를 함께 읽어 올 수 있습니다.
+ * 디스크 I/O 동안에는 frame_lock을 잠시 놓으며, victim은 pinned 상태로 보호됩니다.
+ * 반환된 프레임은 pinned 상태입니다. */
+static size_t
+vm_evict_frames(struct frame *victims[], size_t max, struct supplemental_page_table *spt)
+{
+   struct page *anon[SWAP_CLUSTER];
+   struct page *owner[SWAP_CLUSTER]; /* 프레임마다 실제로 기록하는 익명 페이지 */
+   bool failed[SWAP_CLUSTER];
+   size_t cnt = 0, anon_cnt = 0;
+   struct list_elem *e;
+
+   ASSERT(max <= SWAP_CLUSTER);
+
+   /* 자기 페이지를 내보낼 때는 묶음 전체에 TLB 무효화를 한 번만 합니다 */
+   evict_owner = spt;
+   tlb_batch_begin();
+   while (cnt < max)
+   {
+      struct frame *victim = vm_get_victim();
+      if (victim == NULL)
+         break;
 
-      return dst_mmap_info;
+      /* 내보내는 도중 내용이 바뀌지 않도록 먼저 모든 매핑의 present 비트를 지웁니다.
+       * dirty 비트는 PTE에 남아 있으므로 swap_out에서 그대로 확인할 수 있습니다. */
+      victim->pinned = true;
+      for (e = list_begin(&victim->mappings); e != list_end(&victim->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         *page->pte &= ~(uint64_t)PTE_P;
+         page_flush_tlb(page);
+      }
+      failed[cnt] = false;
+      owner[cnt] = NULL;
+      victims[cnt++] = victim;
    }
-   else
+   tlb_batch_end();
+   evict_owner = NULL;
+   if (cnt == 0)
+      return 0;
+
+   /* pinned 프레임의 매핑은 다른 스레드가 바꾸지 않으므로 락 없이 순회해도 됩니다 */
+   lock_release(&frame_lock);
+   for (size_t i = 0; i < cnt; i++)
    {
-      struct lazy_load_info *src_info = (struct lazy_load_info *)src_page->uninit.aux;
-      struct lazy_load_info *dst_info = malloc(sizeof(struct lazy_load_info));
-
-      dst_info->file = file_reopen(src_info->file);
-      dst_info->offset = src_info->offset;
-      dst_info->readbyte = src_info->readbyte;
-      dst_info->zerobyte = src_info->zerobyte;
-
-      return dst_info;
+      /* swap-in 뒤로 쓰이지 않은 익명 프레임은 남겨 둔 슬롯을 그대로 쓰고 기록하지 않습니다 */
+      owner[i] = frame_swap_backed_page(victims[i]);
+      for (e = list_begin(&victims[i]->mappings); e != list_end(&victims[i]->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         if (page->operations->type == VM_ANON)
+         {
+            /* 같은 프레임의 두 번째 이후 익명 매핑은 기록하지 않고 아래에서 슬롯을 함께 씁니다 */
+            if (owner[i] != NULL)
+               continue;
+            owner[i] = page;
+            /* 내용이 바뀌었으므로 남겨 둔 슬롯의 사본은 버립니다 */
+            anon_swap_release(page);
+            /* 익명 페이지는 모아 두었다가 주소 순으로 한꺼번에 기록합니다 */
+            if (anon_cnt < SWAP_CLUSTER)
+            {
+               size_t j = anon_cnt++;
+               for (; j > 0 && page_addr_less(page, anon[j - 1]); j--)
+                  anon[j] = anon[j - 1];
+               anon[j] = page;
+               continue;
+            }
+         }
+         /* 실제로 기록하는 경우(dirty 파일 페이지, 묶음에 못 든 익명 페이지)만 비용을 잽니다 */
+         enum vmstat_evict type = page_evict_type(page);
+         bool writes = type == VMSTAT_EVICT_ANON || (type == VMSTAT_EVICT_FILE && page_is_dirty(page));
+         uint64_t start = rdtsc();
+         if (!swap_out(page))
+            failed[i] = true;
+         else if (writes)
+            vmstat_writeback(type, 1, rdtsc() - start);
+      }
    }
-}
-
-/*
+   if (anon_cnt > 0)
+   {
+      uint64_t start = rdtsc();
+      anon_swap_out_cluster(anon, anon_cnt);
+      vmstat_writeback(VMSTAT_EVICT_ANON, anon_cnt, rdtsc() - start);
+   }
+   for (size_t i = 0; i < cnt; i++)
+   {
+      if (owner[i] == NULL || !anon_is_swapped(owner[i]))
+         continue;
+      for (e = list_begin(&victims[i]->mappings); e != list_end(&victims[i]->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         if (page != owner[i] && page->operations->type == VM_ANON)
+         {
+            anon_swap_release(page);
+            anon_swap_share(page, owner[i]);
+         }
+      }
+   }
+   lock_acquire(&frame_lock);
+
+   size_t evicted = 0;
+   tlb_batch_begin();
+   for (size_t i = 0; i < cnt; i++)
+   {
+      struct frame *victim = victims[i];
+
+      /* 보관할 곳을 얻지 못한 익명 페이지가 있으면 그 프레임은 내보내지 못한 것입니다 */
+      for (e = list_begin(&victim->mappings); e != list_end(&victim->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         if (page->operations->type == VM_ANON && !anon_is_swapped(page))
+            failed[i] = true;
+      }
+
+      if (failed[i])
+      {
+         /* 내보내지 못했으면 이미 잡은 슬롯을 돌려주고 매핑을 되살립니다 */
+         for (e = list_begin(&victim->mappings); e != list_end(&victim->mappings); e = list_next(e))
+         {
+            struct page *page = list_entry(e, struct page, map_elem);
+            if (page->operations->type == VM_ANON)
+               anon_swap_release(page);
+            *page->pte |= PTE_P;
+         }
+         frame_unpin(victim);
+         continue;
+      }
+
+      while (!list_empty(&victim->mappings))
+      {
+         struct page *page = list_entry(list_front(&victim->mappings), struct page, map_elem);
+         vmstat_evict(page_evict_type(page));
+         frame_unmap_page(page);
+      }
+      text_cache_remove(victim);
+      victims[evicted++] = victim;
+   }
+   tlb_batch_end();
+   evict_cnt += evicted;
+   cond_broadcast(&frame_unpinned, &frame_lock);
+
+   return evicted;
+}
+
+/* 상주 페이지 수가 공평한 몫을 넘은 주소 공간 중 가장 많이 쓰는 것을 반환합니다.
+ * 그런 주소 공간이 없거나 상주 페이지가 있는 프로세스가 하나뿐이면 NULL. */
+static struct supplemental_page_table *
+rss_hog(void)
+{
+   struct supplemental_page_table *hog = NULL;
+   struct list_elem *e;
+
+   if (rss_list_cnt < 2)
+      return NULL;
+   size_t fair = frame_cnt / rss_list_cnt;
+   for (e = list_begin(&rss_list); e != list_end(&rss_list); e = list_next(e))
+   {
+      struct supplemental_page_table *spt = list_entry(e, struct supplemental_page_table, rss_elem);
+      if (spt->rss > fair && (hog == NULL || spt->rss > hog->rss))
+         hog = spt;
+   }
+   return hog;
+}
+
+/* 빈 프레임이 모자랄 때 vm_evict_frames로 최대 MAX개 프레임을 내보냅니다.
+ * 공평한 몫을 넘어 쓰는 프로세스가 있으면 그 프로세스의 프레임부터 내보내고,
+ * 그 프로세스에서 고를 프레임이 없으면 전체에서 고릅니다. */
+static size_t
+vm_evict_fair(struct frame *victims[], size_t max)
+{
+   struct supplemental_page_table *hog = rss_hog();
+   size_t cnt;
+
+   if (hog != NULL && (cnt = vm_evict_frames(victims, max, hog)) > 0)
+   {
+      rss_fair_evict_cnt += cnt;
+      return cnt;
+   }
+   return vm_evict_frames(victims, max, NULL);
+}
+
+/* SPT의 상주 페이지 수가 상한보다 ROOM만큼 작아지도록 SPT가 매핑한 프레임을 내보냅니다.
+ * 내보낼 프레임이 없으면 상한을 넘은 채로 둡니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static void
+rss_trim(struct supplemental_page_table *spt, size_t room)
+{
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   while (spt->rss_limit > 0 && spt->rss + room > spt->rss_limit)
+   {
+      struct frame *victims[SWAP_CLUSTER];
+      size_t want = spt->rss + room - spt->rss_limit;
+      size_t cnt = vm_evict_frames(victims, want < SWAP_CLUSTER ? want : SWAP_CLUSTER, spt);
+      if (cnt == 0)
+         break;
+      for (size_t i = 0; i < cnt; i++)
+         frame_free(victims[i]);
+      cond_broadcast(&frame_unpinned, &frame_lock);
+      rss_limit_evict_cnt += cnt;
+   }
+}
+
+/* palloc으로 얻은 유저 풀 페이지 KVA의 프레임 디스크립터를 사용 중으로 표시합니다.
+ * 반환된 프레임은 pinned 상태입니다. */
+static struct frame *
+frame_take(void *kva)
+{
+   /* 디스크립터는 미리 할당되어 있으므로 인덱스로 찾기만 하면 됩니다 */
+   struct frame *frame = frame_from_kva(kva);
+   ASSERT(!frame->in_use);
+   ASSERT(list_empty(&frame->mappings));
+   ASSERT(frame->text_inode == NULL);
+
+   frame->in_use = true;
+   frame->ref_cnt = 0; // 매핑 수 (COW extra 과제 용)
+   frame->pinned = true;
+   frames_in_use++;
+   evict_insert(frame);
+   return frame;
+}
+
+/* pinned 상태인 프레임이 하나라도 있으면 true를 반환합니다. */
+static bool
+frame_any_pinned(void)
+{
+   for (size_t i = 0; i < frame_cnt; i++)
+      if (frame_table[i].in_use && frame_table[i].pinned)
+         return true;
+   return false;
+}
+
+/* 빈 프레임이 low 워터마크 아래로 내려갔으면 회수 스레드를 깨웁니다. */
+static void
+reclaim_check_watermark(void)
+{
+   if (frame_cnt - frames_in_use < reclaim_low_wm)
+   {
+      reclaim_wakeups++;
+      sema_up(&reclaim_sema);
+   }
+}
+
+/* 백그라운드 회수 스레드.
+ * 폴트 경로 대신 미리 victim을 내보내(dirty anon/mmap 페이지의 write-back 포함)
+ * 대부분의 폴트가 빈 프레임을 바로 얻도록 합니다. */
+static void
+reclaim_thread(void *aux UNUSED)
+{
+   for (;;)
+   {
+      sema_down(&reclaim_sema);
+
+      lock_acquire(&frame_lock);
+      /* 교체 후보로 건너뛴 dirty 프레임을 먼저 기록해 둡니다 */
+      while (clean_queue_cnt > 0)
+      {
+         struct frame *frame = clean_queue[--clean_queue_cnt];
+         bool mapped;
+         frame->clean_queued = false;
+         if (frame_launder_anon(frame))
+            cleaned_page_cnt++;
+         else
+            cleaned_page_cnt += frame_write_back(frame, &mapped);
+      }
+      while (frame_cnt - frames_in_use < reclaim_high_wm)
+      {
+         struct frame *victims[SWAP_CLUSTER];
+         size_t want = reclaim_high_wm - (frame_cnt - frames_in_use);
+         size_t cnt = vm_evict_fair(victims, want < SWAP_CLUSTER ? want : SWAP_CLUSTER);
+         if (cnt == 0)
+            break;
+         for (size_t i = 0; i < cnt; i++)
+            frame_free(victims[i]);
+         cond_broadcast(&frame_unpinned, &frame_lock);
+         reclaim_bg_cnt += cnt;
+      }
+      lock_release(&frame_lock);
+   }
+}
+
+/* PAGE가 dirty한 mmap 페이지이면 프레임에서 내리지 않고 파일에 기록합니다.
+ * dirty 비트를 기록 전에 지우므로, 기록하는 동안 들어온 쓰기는 dirty로 남아 다음 기록 때 반영됩니다.
+ * I/O 동안에는 frame_lock을 놓고 프레임을 pinned 상태로 두어 교체와 해제를 막습니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. 기록했으면 true를 반환하고,
+ * 기록에 실패하면 *FAILED를 true로 설정합니다. */
+static bool
+vm_write_back_page(struct page *page, bool *failed)
+{
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   wait_for_eviction(page);
+   struct frame *frame = page->frame;
+   if (frame == NULL || page->operations->type != VM_FILE || !page_is_dirty(page))
+      return false;
+
+   frame->pinned = true;
+   page_set_dirty(page, false);
+   lock_release(&frame_lock);
+   bool success = file_backed_write_back(page);
+   lock_acquire(&frame_lock);
+   /* 기록하지 못한 내용을 잃지 않도록 dirty로 되돌립니다 */
+   if (!success)
+   {
+      page_set_dirty(page, true);
+      *failed = true;
+   }
+   frame_unpin(frame);
+   return success;
+}
+
+/* FRAME에 매핑된 dirty한 mmap 페이지를 모두 파일에 기록하고 기록한 페이지 수를 반환합니다.
+ * 쓰기 가능한 mmap 페이지가 매핑되어 있으면 *MAPPED를 true로 설정합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static size_t
+frame_write_back(struct frame *frame, bool *mapped)
+{
+   size_t written = 0;
+   bool failed = false;
+   bool progress = true;
+
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   /* 기록하는 동안 frame_lock을 놓으므로 한 페이지를 쓸 때마다 매핑을 처음부터 다시 봅니다 */
+   while (progress && !failed && frame->in_use && !frame->pinned)
+   {
+      struct list_elem *e;
+
+      progress = false;
+      for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         if (page->operations->type != VM_FILE || !page->writable)
+            continue;
+         *mapped = true;
+         if (vm_write_back_page(page, &failed))
+         {
+            written++;
+            progress = true;
+            break;
+         }
+      }
+   }
+   return written;
+}
+
+/* 익명 페이지를 담은 dirty한 FRAME의 내용을 프레임에서 내리지 않고 스왑 슬롯에 기록해 둡니다.
+ * 기록 전에 모든 매핑의 dirty 비트를 지우므로, 기록하는 동안 들어온 쓰기는 dirty로 남아
+ * 교체될 때 다시 기록됩니다. 쓰이지 않으면 교체할 때 I/O 없이 비울 수 있습니다.
+ * I/O 동안에는 frame_lock을 놓고 프레임을 pinned 상태로 두어 교체와 해제를 막습니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. 기록했으면 true를 반환합니다. */
+static bool
+frame_launder_anon(struct frame *frame)
+{
+   struct page *owner = NULL;
+   struct list_elem *e;
+
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   if (!frame->in_use || frame->pinned || frame->huge || frame_is_clean(frame) || swap_full())
+      return false;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if (page->operations->type == VM_ANON)
+      {
+         owner = page;
+         break;
+      }
+   }
+   if (owner == NULL)
+      return false;
+
+   frame->pinned = true;
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+      page_set_dirty(list_entry(e, struct page, map_elem), false);
+   lock_release(&frame_lock);
+
+   /* 한 벌만 기록하고 프레임을 함께 쓰는 다른 익명 페이지들은 그 슬롯을 함께 가리킵니다 */
+   for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+   {
+      struct page *page = list_entry(e, struct page, map_elem);
+      if (page->operations->type == VM_ANON)
+         anon_swap_release(page);
+   }
+   bool success = anon_writeback(owner, frame->kva);
+   if (success)
+      for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+      {
+         struct page *page = list_entry(e, struct page, map_elem);
+         if (page != owner && page->operations->type == VM_ANON)
+            anon_swap_share(page, owner);
+      }
+
+   lock_acquire(&frame_lock);
+   /* 기록하지 못한 내용을 잃지 않도록 dirty로 되돌립니다 */
+   if (!success)
+      for (e = list_begin(&frame->mappings); e != list_end(&frame->mappings); e = list_next(e))
+         page_set_dirty(list_entry(e, struct page, map_elem), true);
+   frame_unpin(frame);
+   return success;
+}
+
+/* 프레임 테이블을 한 바퀴 돌며 dirty한 mmap 페이지를 모두 파일에 기록합니다.
+ * 쓰기 가능한 mmap 페이지가 하나라도 매핑되어 있으면 true를 반환합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static bool
+vm_flush_frames(void)
+{
+   bool mapped = false;
+
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   for (size_t i = 0; i < frame_cnt; i++)
+      flush_page_cnt += frame_write_back(&frame_table[i], &mapped);
+   flush_pass_cnt++;
+   return mapped;
+}
+
+/* 백그라운드 write-back 스레드.
+ * 쓰기 가능한 mmap 페이지가 매핑되면 깨어나, 그런 페이지가 남아 있는 동안
+ * flush_interval 틱마다 dirty한 mmap 페이지를 파일에 기록합니다. */
+static void
+flush_thread(void *aux UNUSED)
+{
+   for (;;)
+   {
+      sema_down(&flush_sema);
+
+      bool armed = true;
+      while (armed)
+      {
+         timer_sleep(flush_interval);
+
+         lock_acquire(&frame_lock);
+         armed = flush_armed = vm_flush_frames();
+         lock_release(&frame_lock);
+      }
+   }
+}
+
+/* palloc()을 사용하여 프레임을 할당합니다.
+ * 사용 가능한 페이지가 없으면 페이지를 교체(evict)하여 반환합니다.
+ * 이 함수는 항상 유효한 주소를 반환합니다. 즉, 사용자 풀 메모리가 가득 차면,
+ * 이 함수는 프레임을 교체하여 사용 가능한 메모리 공간을 확보합니다.
+ * 반환된 프레임은 pinned 상태이므로 내용을 채운 뒤 호출자가 unpin 해야 합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static struct frame *
+vm_get_frame(void)
+{
+   ASSERT(lock_held_by_current_thread(&frame_lock));
+
+   void *kva;
+   /* 내용은 항상 swap_in(초기화 함수, 스왑, 파일 읽기)이 채우므로 PAL_ZERO는 필요 없습니다 */
+   while ((kva = palloc_get_page(PAL_USER)) == NULL)
+   {
+      /* 빈 프레임이 없으면 폴트 경로에서 직접 victim을 내보냅니다 (direct reclaim).
+       * 한 묶음을 내보내 하나는 바로 쓰고 나머지는 뒤따르는 폴트를 위해 풀에 돌려줍니다.
+       * 공평한 몫을 넘어 쓰는 프로세스가 있으면 그 프로세스가 먼저 내놓습니다. */
+      struct frame *victims[SWAP_CLUSTER];
+      size_t cnt = vm_evict_fair(victims, SWAP_CLUSTER);
+      if (cnt > 0)
+      {
+         ASSERT(victims[0]->ref_cnt == 0);
+         /* 교체 정책에는 새로 들어온 프레임으로 보입니다 */
+         evict_remove(victims[0]);
+         evict_insert(victims[0]);
+         for (size_t i = 1; i < cnt; i++)
+            frame_free(victims[i]);
+         reclaim_direct_cnt += cnt;
+         reclaim_check_watermark();
+         return victims[0];
+      }
+
+      /* 모든 프레임이 pinned 상태라면 하나가 풀릴 때까지 기다립니다 */
+      if (!frame_any_pinned())
+         PANIC("vm_get_frame: no frame to evict");
+      cond_wait(&frame_unpinned, &frame_lock);
+   }
+
+   struct frame *frame = frame_take(kva);
+   reclaim_check_watermark();
+
+   return frame;
+}
+
+/* Growing the stack. */
+static void
+vm_stack_growth(void *addr UNUSED)
+{
+   /* 스택 최하단에 익명 페이지를 추가하여 사용
+    * addr은 PGSIZE로 내림(정렬)하여 사용    */
+   vm_alloc_page(VM_ANON, addr, true); // 스택 최하단에 익명 페이지 추가
+   vm_claim_page(addr);
+}
+
+/* PAGE가 아직 올라온 적 없고 내용이 전부 0인 익명 페이지이면 true를 반환합니다.
+ * 초기화 함수가 없는 페이지(스택 등)와 파일에서 읽을 바이트가 없는 ELF 세그먼트(bss)가
+ * 해당합니다. */
+static bool
+page_is_zero_fill(struct page *page)
+{
+   if (page->operations->type != VM_UNINIT || VM_TYPE(page->uninit.type) != VM_ANON)
+      return false;
+   if (page->uninit.init == NULL)
+      return true;
+   if (page->uninit.init == lazy_load_segment)
+      return segment_page_read_bytes(page->uninit.aux, page->va) == 0;
+   return false;
+}
+
+/* 읽기 폴트가 난 zero-fill 페이지 PAGE에 공유 zero 프레임을 읽기 전용으로 매핑합니다.
+ * 페이지는 uninit 상태로 남으며, 첫 쓰기 때 vm_handle_wp가 초기화합니다. */
+static bool
+vm_map_zero_page(struct page *page)
+{
+   lock_acquire(&frame_lock);
+   bool success = frame_map_page(zero_frame, page, false);
+   if (success)
+      zero_map_cnt++;
+   lock_release(&frame_lock);
+   return success;
+}
+
+/* Handle the fault on write_protected page */
+static bool
+vm_handle_wp(struct page *page UNUSED)
+{
+   if (page == NULL)
+   {
+      return false;
+   }
+
+   lock_acquire(&frame_lock);
+   wait_for_eviction(page);
+   struct frame *copy_frame = page->frame;
+
+   /* 그 사이 교체되었다면 일반 폴트처럼 다시 올립니다 */
+   if (copy_frame == NULL)
+   {
+      lock_release(&frame_lock);
+      return vm_do_claim_page(page);
+   }
+
+   /* zero 프레임에 대한 첫 쓰기: 매핑을 떼고 개인 프레임에서 초기화합니다 */
+   if (copy_frame == zero_frame)
+   {
+      frame_unmap_page(page);
+      zero_break_cnt++;
+      lock_release(&frame_lock);
+      return vm_do_claim_page(page);
+   }
+
+   if (copy_frame->ref_cnt > 1)
+   {
+      /* 공유 중인 프레임: 내 매핑만 떼어 내 사본으로 옮깁니다.
+       * 새 프레임을 얻는 동안 원본이 교체되지 않도록 pin 해 둡니다 */
+      copy_frame->pinned = true;
+      struct frame *frame = vm_get_frame();
+      memcpy(frame->kva, copy_frame->kva, PGSIZE);
+      /* 새 PTE에는 원본의 dirty 비트가 없으므로 남겨 둔 슬롯의 사본은 믿을 수 없습니다 */
+      if (page->operations->type == VM_ANON)
+         anon_swap_release(page);
+      frame_unmap_page(page);
+      bool success = frame_map_page(frame, page, true);
+      if (success)
+         cow_copy_cnt++;
+      frame_unpin(frame);
+      if (!success)
+         frame_free(frame);
+      frame_unpin(copy_frame);
+      lock_release(&frame_lock);
+      return success;
+   }
+
+   /* 마지막 공유자: 그대로 쓰기 권한만 돌려줍니다 */
+   *page->pte |= PTE_W;
+   page_flush_tlb(page);
+   lock_release(&frame_lock);
+   return true;
+}
+
+/* SEQUENTIAL 조언을 받은 PAGE에 폴트가 나면, 스캔이 이미 한 창(FAULT_AROUND_MAX) 이상
+ * 지나간 뒤쪽 페이지들의 accessed 비트를 지워 clock이 그 프레임부터 내보내게 합니다.
+ * 순차 스캔이 다른 작업 집합을 밀어내지 않고 자기가 지나간 자리를 재사용하게 됩니다. */
+static void
+vm_age_behind(struct page *page)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+
+   lock_acquire(&frame_lock);
+   for (size_t i = FAULT_AROUND_MAX; i < 2 * FAULT_AROUND_MAX; i++)
+   {
+      if ((uintptr_t)page->va < i * PGSIZE)
+         break;
+      struct page *behind = spt_find_page(spt, page->va - i * PGSIZE);
+      struct frame *frame = behind != NULL ? behind->frame : NULL;
+      if (frame == NULL || frame == zero_frame || frame->pinned ||
+          behind->advice != VM_ADV_SEQUENTIAL)
+         continue;
+      if (frame_test_and_clear_accessed(frame))
+         drop_behind_cnt++;
+   }
+   lock_release(&frame_lock);
+}
+
+/* Return true on success */
+/* bogus 폴트인지? 스택확장 폴트인지?
+ * SPT 뒤져서 존재하면 bogus 폴트!!
+ * addr이 유저 스택 시작 주소 + 1MB를 넘지 않으면 스택확장 폴트
+ * 찐폴트면 false 리턴
+ * 아니면 vm_do_claim_page 호출
+ * 스택확장 폴트에서 valid를 확인하려면 유저 스택 시작 주소 + 1MB를 넘는지 확인
+ * addr = thread 내의 user_rsp
+ * addr은 user_rsp보다 크면 안됨
+ * stack_growth 호출해야함 */
+/* 프레임에 올라와 있지 않은 PAGE를 올리는 폴트의 종류 */
+static enum vmstat_fault
+page_fault_class(struct page *page)
+{
+   switch (page_get_type(page))
+   {
+   case VM_ANON:
+      if (page->operations->type == VM_ANON)
+         return anon_is_swapped(page) ? VMSTAT_FAULT_SWAP : VMSTAT_FAULT_ZERO;
+      return page_segment(page) != NULL ? VMSTAT_FAULT_ELF : VMSTAT_FAULT_ZERO;
+   case VM_TEXT:
+      return VMSTAT_FAULT_ELF;
+   default:
+      return VMSTAT_FAULT_MMAP;
+   }
+}
+
+/* vm_try_handle_fault의 본체. 처리한 폴트의 종류를 *CLASS에 기록합니다. */
+static bool
+vm_handle_fault(void *addr, bool write, enum vmstat_fault *class)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   addr = pg_round_down(addr);
+   fault_cnt++;
+
+   uintptr_t rsp = thread_current()->user_rsp; // 유저 스택의 rsp 가져오기
+
+   struct page *page = spt_find_page(spt, addr);
+   if (page == NULL)
+   {
+      /* 페이지가 없으면 주소가 속한 영역으로 폴트를 분류합니다.
+       * 스택 영역 안에서 rsp 근처이면 스택 성장, 그 외에는 찐 폴트 */
+      struct vma *vma = vma_find(&spt->vmas, addr);
+      if (vma != NULL && vma->kind == VMA_STACK && (uintptr_t)addr >= rsp - STACK_GROW_RANGE)
+      {
+         *class = VMSTAT_FAULT_STACK;
+         vm_stack_growth(addr);
+         return true;
+      }
+      /* 힙과 익명 mmap 영역은 처음 접근하는 페이지를 그때 만듭니다 */
+      if (vma == NULL || !vma_is_demand_zero(vma) || !vm_alloc_page(VM_ANON, addr, vma->writable))
+         return false;
+      page = spt_find_page(spt, addr);
+   }
+
+   if (write == true && !page->writable)
+      return false;
+
+   if (write == true && page->writable && page->frame != NULL)
+   {
+      *class = VMSTAT_FAULT_COW;
+      return vm_handle_wp(page);
+   }
+
+   /* 한 번도 쓰이지 않은 익명 페이지를 읽기만 하면 프레임을 새로 쓰지 않습니다 */
+   if (!write && page->frame == NULL && page_is_zero_fill(page))
+   {
+      *class = VMSTAT_FAULT_ZERO;
+      return vm_map_zero_page(page);
+   }
+
+   /* 다른 스레드가 이 페이지를 교체하는 중이면 끝날 때까지 기다립니다 */
+   if (page->frame != NULL)
+   {
+      lock_acquire(&frame_lock);
+      wait_for_eviction(page);
+      bool resident = page->frame != NULL;
+      lock_release(&frame_lock);
+      if (resident)
+      {
+         *class = VMSTAT_FAULT_MINOR;
+         return true;
+      }
+   }
+
+   ASSERT(page->operations != NULL && page->operations->swap_in != NULL);
+
+   *class = page_fault_class(page);
+   bool success = vm_do_claim_page(page);
+   if (success && page->advice == VM_ADV_SEQUENTIAL)
+      vm_age_behind(page);
+   return success;
+}
+
+/* 폴트를 처리하고 종류별 횟수와 걸린 시간을 기록합니다.
+ * 시스템 콜이 사용자 버퍼를 확인하며 부른 경우(F == NULL)와 커널 모드에서 난 폴트는
+ * 원인과 관계없이 kernel로, 처리하지 못한 폴트는 bogus로 셉니다. */
+bool vm_try_handle_fault(struct intr_frame *f, void *addr,
+                         bool user, bool write, bool not_present UNUSED)
+{
+   enum vmstat_fault class = VMSTAT_FAULT_BOGUS;
+   uint64_t start = rdtsc();
+
+   bool success = vm_handle_fault(addr, write, &class);
+   if (!success)
+      class = VMSTAT_FAULT_BOGUS;
+   else if (f == NULL || !user)
+      class = VMSTAT_FAULT_KERNEL;
+   vmstat_fault(class, rdtsc() - start);
+   return success;
+}
+
+/* Free the page.
+ * DO NOT MODIFY THIS FUNCTION. */
+void vm_dealloc_page(struct page *page)
+{
+   struct frame *frame;
+
+   /* destroy는 write-back을 위해 프레임 내용을 볼 수 있으므로
+    * 매핑 해제는 destroy 이후에 합니다. write-back I/O 동안 frame_lock을
+    * 잡고 있지 않도록 프레임을 고정한 뒤 lock을 놓습니다. */
+   lock_acquire(&frame_lock);
+   wait_for_eviction(page);
+   frame = page->frame;
+   if (frame != NULL && frame != zero_frame)
+      frame->pinned = true;
+   lock_release(&frame_lock);
+
+   destroy(page);
+
+   lock_acquire(&frame_lock);
+   if (frame != NULL)
+   {
+      if (frame != zero_frame)
+         frame_unpin(frame);
+      frame_unmap_page(page);
+      if (frame->ref_cnt == 0 && !frame->pinned && frame != zero_frame)
+         frame_free(frame);
+   }
+   lock_release(&frame_lock);
+   free(page);
+}
+
+/* VA에 할당된 페이지를 요구합니다. 
+   이 함수는 Page Fault 발생 시 호출되어 가상 페이지를 물리 메모리에 로드합니다.    
+*/
+bool vm_claim_page(void *va UNUSED)
+{  
+   /* 1. 가상 주소로 SPT에서 해당 페이지 구조체 찾기 */
+   struct page *page = spt_find_page(&thread_current()->spt,   // 현재 스레드의 보조 페이지 테이블
+                                     va);                      // 요청된 가상 주소(e.g. 0x400000000(예시임 너무 신경 ㄴㄴ), 스택 주소, 힙 주소 등등)
+   /* 2. 예외 처리 → 페이지 존재 여부 검증
+      page == NULL인 case :
+      - 할당되지 않은 메모리 영역에 접근 (segmentation fault 상황)
+      - 잘못된 가상 주소 접근 
+      - 아직 vm_alloc_page로 생성되지 않은 페이지
+   */
+   if (page == NULL) 
+   {
+      return false;  // 실패 : 유효하지 않은 페이지 요청
+   }
+
+   /* 3. 실제 페이지 클레임 수행*/
+   return vm_do_claim_page(page);
+}
+
+/* MADV_WILLNEED: 아직 올라오지 않은 PAGE를 폴트를 기다리지 않고 지금 올립니다.
+ * 내용을 읽을 필요가 없는 zero-fill 페이지는 건너뜁니다.
+ * 교체를 일으키지 않도록 빈 프레임이 low 워터마크 이하이거나 상주 페이지 상한에 닿았으면
+ * false를 반환해 멈춥니다. */
+static bool
+vm_prefetch_page(struct page *page)
+{
+   if (page->frame != NULL || page_is_zero_fill(page))
+      return true;
+   if (frame_cnt - frames_in_use <= reclaim_low_wm || rss_full(page->spt))
+      return false;
+   if (vm_do_claim_page(page))
+      willneed_cnt++;
+   return true;
+}
+
+/* MADV_DONTNEED: PAGE의 프레임과 스왑 슬롯을 바로 돌려주고 처음 상태로 되돌립니다.
+ * 익명 페이지는 다음 접근 때 0으로 채워지고, mmap 페이지는 dirty이면 파일에 기록한 뒤
+ * 다음 접근 때 파일에서 다시 읽습니다. 올라온 적 없는 페이지는 그대로 둡니다. */
+static void
+vm_drop_page(struct supplemental_page_table *spt, struct page *page)
+{
+   enum vm_type type = page->operations->type;
+   void *va = page->va;
+   bool writable = page->writable;
+   enum vm_advice advice = page->advice;
+   struct segment *seg = NULL;
+
+   if (type == VM_FILE)
+      seg = segment_get(page->file.seg);
+   else if (type != VM_ANON)
+      return;
+
+   /* 페이지를 지우면(write-back, 매핑 해제, 슬롯 반환) 같은 자리에 새 uninit 페이지를 만듭니다 */
+   spt_remove_page(spt, page);
+   bool success = seg != NULL
+                      ? vm_alloc_page_with_initializer(VM_MMAP, va, writable, lazy_load_segment, seg)
+                      : vm_alloc_page(VM_ANON, va, writable);
+   if (!success)
+   {
+      /* 메모리가 없어 되돌리지 못한 자리는 매핑되지 않은 주소처럼 폴트가 납니다 */
+      if (seg != NULL)
+         segment_put(seg);
+      return;
+   }
+   spt_find_page(spt, va)->advice = advice;
+   dontneed_cnt++;
+}
+
+/* [ADDR, ADDR + LENGTH)의 페이지들에 madvise 조언 ADVICE를 적용합니다.
+ * ADDR은 페이지 정렬되어야 하고 범위 전체가 영역(VMA) 안에 있어야 합니다.
+ * ELF 세그먼트의 내용은 다시 만들 수 없으므로 DONTNEED는 mmap, 스택 영역에만 쓸 수 있습니다.
+ * WILLNEED는 빈 프레임이 있는 만큼만 올리고, 나머지는 폴트 때 올립니다. */
+bool vm_madvise(void *addr, size_t length, enum vm_advice advice)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   uint8_t *start = addr;
+   uint8_t *end = pg_round_up(start + length);
+
+   if (pg_ofs(addr) != 0 || end < start || (end > start && !is_user_vaddr(end - 1)))
+      return false;
+
+   /* 먼저 범위 전체를 확인해 실패할 때는 아무것도 바꾸지 않습니다 */
+   for (uint8_t *va = start; va < end;)
+   {
+      struct vma *vma = vma_find(&spt->vmas, va);
+      if (vma == NULL || (advice == VM_ADV_DONTNEED && vma->kind == VMA_SEGMENT))
+         return false;
+      va = vma->end;
+   }
+
+   for (uint8_t *va = start; va < end; va += PGSIZE)
+   {
+      struct page *page = spt_find_page(spt, va);
+      if (page == NULL)
+         continue;
+
+      switch (advice)
+      {
+      case VM_ADV_WILLNEED:
+         if (!vm_prefetch_page(page))
+            return true;
+         break;
+      case VM_ADV_DONTNEED:
+         vm_drop_page(spt, page);
+         break;
+      default:
+         page->advice = advice;
+         break;
+      }
+   }
+   return true;
+}
+
+/* 힙의 끝(brk)을 INCREMENT 바이트만큼 옮기고 이전 brk를 반환합니다.
+ * 힙은 첫 호출 때 마지막 ELF 세그먼트 바로 뒤에서 시작하며, 페이지는 미리 만들지 않고
+ * 처음 접근할 때 0으로 채워진 익명 페이지로 만듭니다. 줄인 범위의 페이지는 바로 해제합니다.
+ * 다른 영역과 겹치거나 힙 시작보다 아래로 줄이려 하면 (void *) -1을 반환합니다. */
+void *
+vm_sbrk(intptr_t increment)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+
+   if (spt->heap_start == NULL)
+   {
+      uint8_t *base = vma_kind_end(&spt->vmas, VMA_SEGMENT);
+      if (base == NULL)
+         return (void *)-1;
+      spt->heap_start = spt->brk = base;
+   }
+
+   uint8_t *old_brk = spt->brk;
+   uint8_t *new_brk = old_brk + increment;
+   if (increment < 0 ? new_brk < spt->heap_start || new_brk > old_brk
+                     : new_brk < old_brk || !is_user_vaddr(new_brk))
+      return (void *)-1;
+
+   uint8_t *old_end = pg_round_up(old_brk);
+   uint8_t *new_end = pg_round_up(new_brk);
+   struct vma *vma = old_end > spt->heap_start ? vma_find(&spt->vmas, spt->heap_start) : NULL;
+
+   if (new_end > old_end)
+   {
+      if (vma == NULL)
+         vma = vma_insert(&spt->vmas, spt->heap_start, new_end, VMA_HEAP, true);
+      else if (!vma_resize(&spt->vmas, vma, new_end))
+         vma = NULL;
+      if (vma == NULL)
+         return (void *)-1;
+   }
+   else if (new_end < old_end)
+   {
+      for (uint8_t *va = new_end; va < old_end; va += PGSIZE)
+      {
+         struct page *page = spt_find_page(spt, va);
+         if (page != NULL)
+            spt_remove_page(spt, page);
+      }
+      if (new_end == spt->heap_start)
+         vma_remove(&spt->vmas, vma);
+      else
+         vma_resize(&spt->vmas, vma, new_end);
+   }
+   spt->brk = new_brk;
+   return old_brk;
+}
+
+/* [ADDR, ADDR + LENGTH)의 각 페이지가 지금 프레임에 올라와 있으면 VEC의 해당 바이트를 1,
+ * 아니면 0으로 채웁니다. 범위에 영역(VMA) 밖의 주소가 있으면 false를 반환합니다.
+ * 결과는 호출 시점의 스냅숏이므로 frame_lock 없이 읽습니다. */
+bool vm_mincore(void *addr, size_t length, unsigned char *vec)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   uint8_t *start = addr;
+   uint8_t *end = pg_round_up(start + length);
+
+   if (pg_ofs(addr) != 0 || end < start || (end > start && !is_user_vaddr(end - 1)))
+      return false;
+
+   for (uint8_t *va = start; va < end; va += PGSIZE)
+   {
+      if (vma_find(&spt->vmas, va) == NULL)
+         return false;
+      struct page *page = spt_find_page(spt, va);
+      vec[(va - start) / PGSIZE] = page != NULL && page->frame != NULL;
+   }
+   return true;
+}
+
+/* [ADDR, ADDR + LENGTH)에서 프레임에 올라와 있는 dirty한 mmap 페이지를 프레임에서 내리지 않고
+ * 파일에 기록합니다. 범위에 영역(VMA) 밖의 주소가 있거나 기록에 실패하면 false를 반환합니다. */
+bool vm_msync(void *addr, size_t length)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   uint8_t *start = addr;
+   uint8_t *end = pg_round_up(start + length);
+   bool failed = false;
+
+   if (pg_ofs(addr) != 0 || end < start || (end > start && !is_user_vaddr(end - 1)))
+      return false;
+   for (uint8_t *va = start; va < end; va += PGSIZE)
+      if (vma_find(&spt->vmas, va) == NULL)
+         return false;
+
+   lock_acquire(&frame_lock);
+   for (uint8_t *va = start; va < end && !failed; va += PGSIZE)
+   {
+      struct page *page = spt_find_page(spt, va);
+      if (page != NULL && vm_write_back_page(page, &failed))
+         msync_page_cnt++;
+   }
+   lock_release(&frame_lock);
+   return !failed;
+}
+
+/* 현재 프로세스의 상주 페이지 상한을 PAGES로 바꿉니다. 0이면 제한을 없애며,
+ * RSS_LIMIT_MIN보다 작으면 RSS_LIMIT_MIN으로 올립니다.
+ * 이미 상한을 넘어 있으면 자기 프레임을 바로 내보내 상한 안으로 줄입니다. */
+void vm_set_rss_limit(size_t pages)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+
+   lock_acquire(&frame_lock);
+   spt->rss_limit = pages > 0 && pages < RSS_LIMIT_MIN ? RSS_LIMIT_MIN : pages;
+   rss_trim(spt, 0);
+   lock_release(&frame_lock);
+}
+
+/* 현재 프로세스의 상주 페이지 수를 반환합니다. */
+size_t vm_get_rss(void)
+{
+   return thread_current()->spt.rss;
+}
+
+/* 폴트가 나지 않은 페이지를 미리 올릴 때 쓰는 프레임을 PAGE에 매핑합니다.
+ * 교체를 일으키지 않도록 빈 프레임이 low 워터마크보다 많고 상주 페이지 상한에
+ * 여유가 있을 때만 할당하며, 매핑된 프레임은 pinned 상태입니다. 할당이나 매핑에 실패하면 false를 반환합니다.
+ * frame_lock을 보유한 상태에서 호출해야 합니다. */
+static bool
+frame_map_spare(struct page *page)
+{
+   if (frame_cnt - frames_in_use <= reclaim_low_wm || rss_full(page->spt))
+      return false;
+
+   void *kva = palloc_get_page(PAL_USER);
+   if (kva == NULL)
+      return false;
+
+   struct frame *frame = frame_take(kva);
+   if (!frame_map_page(frame, page, page->writable))
+   {
+      frame_unpin(frame);
+      frame_free(frame);
+      return false;
+   }
+   return true;
+}
+
+/* 스왑된 익명 페이지 PAGE를 (이미 매핑된) 프레임에 읽어 들이면서,
+ * 바로 뒤 가상 주소의 페이지들 중 스왑 슬롯도 이어지는 것들을 같은 디스크 명령으로
+ * 미리 읽어 둡니다(readahead). 교체를 일으키지 않도록 빈 프레임이 low 워터마크보다
+ * 많을 때만 미리 읽습니다. 미리 읽은 페이지는 accessed 비트가 꺼져 있으므로
+ * 쓰이지 않으면 clock이 먼저 내보냅니다.
+ * frame_lock을 보유한 상태에서 호출하며, 락을 놓고 반환합니다. */
+static void
+vm_swap_in_readahead(struct page *page)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   struct page *pages[SWAP_CLUSTER];
+   size_t max = page->advice == VM_ADV_RANDOM ? 1 : SWAP_CLUSTER;
+   size_t cnt = 1;
+
+   pages[0] = page;
+   while (cnt < max)
+   {
+      void *va = page->va + cnt * PGSIZE;
+      if (!is_user_vaddr(va))
+         break;
+
+      struct page *next = spt_find_page(spt, va);
+      if (next == NULL || next->operations->type != VM_ANON || next->frame != NULL ||
+          next->anon.swap_idx != page->anon.swap_idx + (int)cnt)
+         break;
+
+      if (!frame_map_spare(next))
+         break;
+      pages[cnt++] = next;
+   }
+   lock_release(&frame_lock);
+
+   anon_swap_in_cluster(pages, cnt);
+   for (size_t i = 0; i < cnt; i++)
+      frame_unpin(pages[i]->frame);
+}
+
+/* PAGE가 lazy_load_segment로 파일에서 읽어 올 uninit 페이지이면 그 구간 디스크립터를,
+ * 아니면 NULL을 반환합니다. */
+static struct segment *
+page_segment(struct page *page)
+{
+   if (page->operations->type != VM_UNINIT || page->uninit.init != lazy_load_segment)
+      return NULL;
+   return page->uninit.aux;
+}
+
+/* 파일 내용 SRC를 이미 읽어 둔 uninit 페이지 PAGE를 초기화합니다.
+ * uninit_initialize와 lazy_load_segment가 하는 일에서 파일 읽기만 뺀 것입니다. */
+static bool
+vm_fill_lazy_page(struct page *page, const uint8_t *src)
+{
+   struct segment *seg = page_segment(page);
+   struct uninit_page *uninit = &page->uninit;
+   size_t read_bytes = segment_page_read_bytes(seg, page->va);
+   void *kva = page->frame->kva;
+
+   if (!uninit->page_initializer(page, uninit->type, kva))
+      return false;
+   memcpy(kva, src, read_bytes);
+   memset(kva + read_bytes, 0, PGSIZE - read_bytes);
+   segment_put(seg);
+   return true;
+}
+
+/* 파일에서 지연 로딩하는 PAGE(이미 pinned 프레임에 매핑됨)를 올리면서, 바로 뒤
+ * 가상 주소에 있는 같은 파일의 이어지는 부분을 담은 페이지들도 최대
+ * fault_around_pages개까지 함께 매핑하고, 한 번의 file_read_at으로 채웁니다.
+ * 미리 올린 페이지는 accessed 비트가 꺼져 있어 쓰이지 않으면 먼저 교체됩니다.
+ * frame_lock을 보유한 상태에서 호출하며, 락을 놓고 반환합니다. */
+static bool
+vm_fault_around(struct page *page)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   struct segment *seg = page_segment(page);
+   struct page *pages[FAULT_AROUND_MAX];
+   size_t window = fault_around_pages < FAULT_AROUND_MAX ? fault_around_pages : FAULT_AROUND_MAX;
+   /* 순차 접근을 알려 온 영역은 항상 최대 창으로 읽습니다 */
+   if (page->advice == VM_ADV_SEQUENTIAL)
+      window = FAULT_AROUND_MAX;
+   bool ok[FAULT_AROUND_MAX];
+   off_t offset = segment_page_offset(seg, page->va);
+   size_t cnt = 1, total = segment_page_read_bytes(seg, page->va);
+
+   pages[0] = page;
+   /* 앞 페이지들이 파일에서 꽉 차게 읽힐 때만 뒤 페이지가 파일에서 이어집니다 */
+   while (cnt < window && total == cnt * PGSIZE)
+   {
+      void *va = page->va + cnt * PGSIZE;
+      if (!is_user_vaddr(va))
+         break;
+
+      struct page *next = spt_find_page(spt, va);
+      struct segment *next_seg;
+      size_t next_read;
+      if (next == NULL || next->frame != NULL || (next_seg = page_segment(next)) == NULL ||
+          next->uninit.type != page->uninit.type ||
+          (next_read = segment_page_read_bytes(next_seg, va)) == 0 ||
+          file_get_inode(next_seg->file) != file_get_inode(seg->file) ||
+          segment_page_offset(next_seg, va) != offset + (off_t)(cnt * PGSIZE) ||
+          text_cache_find(next) != NULL)
+         break;
+
+      if (!frame_map_spare(next))
+         break;
+      pages[cnt++] = next;
+      total += next_read;
+   }
+   fault_around_cnt++;
+   fault_around_mapped += cnt - 1;
+   lock_release(&frame_lock);
+
+   /* 이어진 파일 영역을 한 번에 읽어 각 페이지에 나눠 담습니다 */
+   uint8_t *buf = cnt > 1 ? palloc_get_multiple(0, cnt) : NULL;
+   if (buf != NULL && file_read_at(seg->file, buf, total, offset) == (off_t)total)
+   {
+      for (size_t i = 0; i < cnt; i++)
+         ok[i] = vm_fill_lazy_page(pages[i], buf + i * PGSIZE);
+   }
+   else
+   {
+      /* 버퍼를 못 얻었거나 읽기에 실패하면 한 페이지씩 원래 경로로 초기화합니다 */
+      for (size_t i = 0; i < cnt; i++)
+         ok[i] = swap_in(pages[i], pages[i]->frame->kva);
+   }
+   if (buf != NULL)
+      palloc_free_multiple(buf, cnt);
+
+   /* 채우지 못한 프레임은 다른 프로세스가 공유하지 않도록 캐시에서 뺍니다 */
+   lock_acquire(&frame_lock);
+   for (size_t i = 0; i < cnt; i++)
+   {
+      if (!ok[i])
+         text_cache_remove(pages[i]->frame);
+      pages[i]->frame->pinned = false;
+   }
+   cond_broadcast(&frame_unpinned, &frame_lock);
+   lock_release(&frame_lock);
+   return ok[0];
+}
+
+/* uninit 페이지 PAGE를 내용을 읽지 않고 타입별 페이지로 초기화합니다.
+ * 내용이 이미 프레임이나 스왑에 있는 경우에 쓰며, lazy_load_segment처럼 aux를 해제합니다. */
+static bool
+vm_init_page_no_load(struct page *page, void *kva)
+{
+   struct uninit_page *uninit = &page->uninit;
+   vm_initializer *init = uninit->init;
+   void *aux = uninit->aux;
+
+   if (!uninit->page_initializer(page, uninit->type, kva))
+      return false;
+   if (init == lazy_load_segment)
+      segment_put(aux);
+   return true;
+}
+
+/* 실행 코드 페이지 PAGE의 내용을 다른 프로세스가 이미 프레임에 올려 두었으면
+ * 디스크를 읽지 않고 그 프레임을 읽기 전용으로 함께 매핑합니다.
+ * 매핑했으면 true를 반환합니다. frame_lock을 보유한 상태에서 호출해야 합니다. */
+static bool
+vm_share_text_page(struct page *page)
+{
+   struct frame *frame;
+
+   /* 캐시된 프레임을 채우거나 내보내는 중이면 끝난 뒤 다시 찾습니다 */
+   while ((frame = text_cache_find(page)) != NULL && frame->pinned)
+      cond_wait(&frame_unpinned, &frame_lock);
+   if (frame == NULL || !frame_map_page(frame, page, false))
+      return false;
+
+   /* 처음 올라오는 페이지는 파일 읽기 없이 초기화만 합니다 */
+   if (page->operations->type == VM_UNINIT && !vm_init_page_no_load(page, frame->kva))
+   {
+      frame_unmap_page(page);
+      return false;
+   }
+   text_share_cnt++;
+   return true;
+}
+
+/* BASE부터 CNT개 페이지 중 SPT에 없는 것들을 0으로 채워질 익명 페이지로 만듭니다.
+ * 메모리가 부족하면 false를 반환하며, 이미 만든 페이지는 그대로 둡니다
+ * (빈 페이지는 폴트 때 만드는 것과 구별되지 않습니다). */
+static bool
+vm_alloc_missing_pages(struct supplemental_page_table *spt, uint8_t *base, size_t cnt)
+{
+   for (size_t i = 0; i < cnt; i++)
+      if (spt_find_page(spt, base + i * PGSIZE) == NULL &&
+          !vm_alloc_page(VM_ANON, base + i * PGSIZE, true))
+         return false;
+   return true;
+}
+
+/* PAGE가 속한 2MB 영역 전체를 대형 페이지 하나로 올릴 수 있으면 올리고 true를 반환합니다.
+ * 영역이 스택이 아닌 쓰기 가능한 VMA 하나 안에 있고, 그 안의 모든 페이지가 아직 올라온
+ * 적 없는 zero-fill 익명 페이지여야 합니다. 물리적으로 연속되고 2MB 정렬된 빈 프레임
+ * 512개를 교체 없이 얻을 수 있을 때만 매핑하며, 아니면 false를 반환해 4KB 경로로 넘깁니다.
+ * frame_lock을 보유한 상태에서 호출하며, 성공하면 락을 놓고 반환합니다. */
+static bool
+vm_claim_huge_page(struct page *page)
+{
+   struct supplemental_page_table *spt = &thread_current()->spt;
+   uint64_t *pml4 = thread_current()->pml4;
+   uint8_t *base = (uint8_t *)((uintptr_t)page->va & ~(HUGE_PGSIZE - 1));
+   struct vma *vma = vma_find(&spt->vmas, base);
+
+   if (vma == NULL || vma->kind == VMA_STACK || !vma->writable ||
+       (uint8_t *)vma->end < base + HUGE_PGSIZE ||
+       (spt->rss_limit > 0 && spt->rss + HUGE_PGCNT > spt->rss_limit))
+      return false;
+   /* 힙과 익명 mmap 영역에서는 아직 만들지 않은 페이지도 zero-fill 페이지로 칩니다 */
+   for (size_t i = 0; i < HUGE_PGCNT; i++)
+   {
+      struct page *p = spt_find_page(spt, base + i * PGSIZE);
+      if (p == NULL ? !vma_is_demand_zero(vma)
+                    : p->frame != NULL || !p->writable || !page_is_zero_fill(p))
+         return false;
+   }
+
+   /* 빈 프레임을 low 워터마크 아래로 끌어내리면 곧바로 회수가 일어나므로 여유가 있을 때만 씁니다.
+    * 쪼갤 때 쓸 페이지 테이블도 미리 얻어 두어 쪼개기가 실패하지 않게 합니다 */
+   uint8_t *kva = NULL;
+   uint64_t *pt = NULL;
+   if (frame_cnt - frames_in_use >= HUGE_PGCNT + reclaim_low_wm)
+      kva = palloc_get_multiple_aligned(PAL_USER, HUGE_PGCNT, HUGE_PGCNT);
+   if (kva != NULL)
+      pt = palloc_get_page(0);
+   if (kva != NULL && pt != NULL && !vm_alloc_missing_pages(spt, base, HUGE_PGCNT))
+   {
+      palloc_free_page(pt);
+      pt = NULL;
+   }
+   if (kva == NULL || pt == NULL || !pml4_set_huge_page(pml4, base, kva, true))
+   {
+      if (kva != NULL)
+         palloc_free_multiple(kva, HUGE_PGCNT);
+      if (pt != NULL)
+         palloc_free_page(pt);
+      huge_fallback_cnt++;
+      return false;
+   }
+
+   uint64_t *pde = pml4e_walk(pml4, (uint64_t)base, false);
+   struct frame *head = frame_from_kva(kva);
+   for (size_t i = 0; i < HUGE_PGCNT; i++)
+   {
+      struct frame *frame = frame_take(kva + i * PGSIZE);
+      frame->huge = true;
+      frame_link_page(frame, spt_find_page(spt, base + i * PGSIZE), pml4, pde);
+   }
+   head->huge_pt = pt;
+   huge_map_cnt++;
+   reclaim_check_watermark();
+   lock_release(&frame_lock);
+
+   /* 프레임들은 pinned 상태이므로 락 없이 페이지를 초기화(0으로 채움)합니다 */
+   for (size_t i = 0; i < HUGE_PGCNT; i++)
+      vm_init_page_no_load(spt_find_page(spt, base + i * PGSIZE), kva + i * PGSIZE);
+
+   lock_acquire(&frame_lock);
+   for (size_t i = 0; i < HUGE_PGCNT; i++)
+      head[i].pinned = false;
+   cond_broadcast(&frame_unpinned, &frame_lock);
+   lock_release(&frame_lock);
+   return true;
+}
+
+/* PAGE를 요구하고 mmu를 설정합니다.*/
+static bool
+vm_do_claim_page(struct page *page)
+{
+   lock_acquire(&frame_lock);
+   /* 상주 페이지 상한에 닿은 프로세스는 자기 프레임을 내보내 자리를 만듭니다 */
+   rss_trim(page->spt, 1);
+   /* 다른 프로세스가 이미 올린 실행 코드는 그 프레임을 함께 씁니다 */
+   if (vm_share_text_page(page))
+   {
+      lock_release(&frame_lock);
+      return true;
+   }
+   /* 정렬된 2MB 익명 영역의 첫 폴트이면 영역 전체를 대형 페이지로 올립니다 */
+   if (huge_pages && page_is_zero_fill(page) && vm_claim_huge_page(page))
+      return true;
+
+   // 1. 물리 프레임 할당 (pinned 상태로 반환됨)
+   struct frame *frame = vm_get_frame();
+
+   /* 2. 페이지 테이블 엔트리 설정(MMU 매핑) + 역매핑 등록
+      실패 case : 
+      - 메모리 부족
+      - 이미 매핑된 주소
+      - 잘못된 권한 
+   */
+   if (!frame_map_page(frame, page, page->writable))
+   {
+      frame_unpin(frame);
+      frame_free(frame);
+      lock_release(&frame_lock);
+      return false;
+   }
+
+   /* 스왑된 익명 페이지는 이웃 페이지와 함께 읽어 들입니다 */
+   if (page->operations->type == VM_ANON && page->anon.swap_idx >= 0)
+   {
+      vm_swap_in_readahead(page);
+      return true;
+   }
+   /* 파일에서 지연 로딩하는 페이지는 뒤따르는 페이지까지 한 번에 읽습니다.
+    * 무작위 접근을 알려 온 영역은 읽은 만큼 버려질 것이므로 하지 않습니다 */
+   if (page_segment(page) != NULL && page->advice != VM_ADV_RANDOM &&
+       (fault_around_pages > 1 || page->advice == VM_ADV_SEQUENTIAL))
+      return vm_fault_around(page);
+   lock_release(&frame_lock);
+
+   // 3. 실제 페이지 내용 로딩 (디스크 I/O 동안 프레임은 pinned 상태)
+   bool success = swap_in(page, frame->kva);
+   if (!success && frame->text_inode != NULL)
+   {
+      /* 채우지 못한 프레임은 다른 프로세스가 공유하지 않도록 캐시에서 뺍니다 */
+      lock_acquire(&frame_lock);
+      text_cache_remove(frame);
+      lock_release(&frame_lock);
+   }
+   frame_unpin(frame);
+   return success;
+}
+
+/* fork: 초기화된 부모 페이지 SRC를 자식 페이지 DST가 복사 없이 물려받게 합니다.
+ * DST는 SRC와 같은 타입으로 방금 만든 uninit 페이지입니다.
+ * - 프레임에 올라와 있으면 두 매핑을 모두 읽기 전용으로 두고 프레임을 함께 씁니다.
+ *   먼저 쓰는 쪽이 vm_handle_wp에서 개인 사본을 만듭니다.
+ * - 스왑된 익명 페이지는 스왑 슬롯(또는 zswap 항목)을 함께 가리킵니다.
+ * - 내려가 있는 파일 페이지는 파일에서 다시 읽도록 uninit으로 남겨 둡니다.
+ * 프레임을 할당하지도, 스왑 I/O를 하지도 않습니다. */
+static bool
+vm_cow_share_page(struct page *dst, struct page *src)
+{
+   bool success = true;
+
+   lock_acquire(&frame_lock);
+   wait_for_eviction(src);
+   struct frame *frame = src->frame;
+   /* 부모의 쓰기 권한을 페이지 단위로 거둬야 하므로 대형 페이지는 쪼갭니다 */
+   if (frame != NULL && frame->huge)
+      frame_split_huge(frame);
+   if (frame != NULL)
+   {
+      /* kva를 넘기지 않아야 익명 페이지 초기화가 공유 프레임을 지우지 않습니다 */
+      success = vm_init_page_no_load(dst, NULL) && frame_map_page(frame, dst, false);
+      if (success)
+      {
+         *src->pte &= ~(uint64_t)PTE_W;
+         page_flush_tlb(src);
+         cow_frame_cnt++;
+      }
+   }
+   else if (src->operations->type == VM_ANON)
+   {
+      success = vm_init_page_no_load(dst, NULL) && anon_swap_share(dst, src);
+      if (success)
+         cow_swap_cnt++;
+   }
+   lock_release(&frame_lock);
+   return success;
+}
+
+/* Initialize new supplemental page table */
+void supplemental_page_table_init(struct supplemental_page_table *spt UNUSED)
+{
+   vma_set_init(&spt->vmas);
+   spt->heap_start = spt->brk = NULL;
+   spt->rss = 0;
+   spt->rss_limit = rss_limit_default;
+   if (!hash_init(&spt->SPT_hash_list, my_hash, my_less, NULL))
+      return;
+}
+
+/* 페이지 번호에 64비트 곱셈 해시(Fibonacci hashing)를 적용합니다.
+ * 해시 테이블은 하위 비트로 버킷을 고르므로, 상위 비트를 접어 내려
+ * 연속된 페이지와 멀리 떨어진 영역(스택, mmap)이 버킷에 고르게 퍼지게 합니다. */
+static uint64_t my_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+   const struct page *page = hash_entry(e, struct page, spt_elem);
+   uint64_t x = pg_no(page->va) * 0x9e3779b97f4a7c15ULL;
+   return x ^ (x >> 32);
+}
+
+static bool my_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+{
+   return hash_entry(a, struct page, spt_elem)->va < hash_entry(b, struct page, spt_elem)->va;
+}
+
+static void *duplicate_aux(struct page *src_page)
+{
+   /* 초기화 함수가 없는 페이지(스택 등)는 aux도 없습니다 */
+   if (src_page->uninit.aux == NULL)
+      return NULL;
+
+   /* 구간 디스크립터는 바뀌지 않으므로 복사하지 않고 참조만 늘려 공유합니다 */
+   ASSERT(src_page->uninit.init == lazy_load_segment);
+   return segment_get(src_page->uninit.aux);
+}
+
+/*
  * supplemental_page_table_copy - 보조 페이지 테이블(dst)에 src 페이지 테이블을 복사합니다.
  * 
  * src의 모든 페이지를 순회하면서 페이지 타입에 따라 적절히 복사 및 초기화 작업을 수행합니다.
@@ -568,16 +2232,22 @@ static void *duplicate_aux(struct page *src_page)
 bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED, struct supplemental_page_table *src UNUSED)
 {
    struct hash_iterator i;
+
+   // 영역(VMA) 정보부터 복제
+   if (!vma_set_copy(&dst->vmas, &src->vmas))
+      return false;
+   dst->heap_start = src->heap_start;
+   dst->brk = src->brk;
+   dst->rss_limit = src->rss_limit;
+
    // src의 해시 테이블 첫 번째 요소로 iterator 초기화
    hash_first(&i, &src->SPT_hash_list);
-   struct thread *cur = thread_current();
 
    // src의 모든 페이지 엔트리를 순회
    while (hash_next(&i))
    {
       // src_page 정보
-      struct SPT_entry *src_entry = hash_entry(hash_cur(&i), struct SPT_entry, elem);
-      struct page *src_page = src_entry->page;
+      struct page *src_page = hash_entry(hash_cur(&i), struct page, spt_elem);
       enum vm_type type = src_page->operations->type;    // 페이지 타입 확인
       void *upage = src_page->va;                        // 가상 주소
       bool writable = src_page->writable;                // 쓰기 가능 여부
@@ -588,49 +2258,43 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED, st
          vm_initializer *init = src_page->uninit.init;
          void *aux = duplicate_aux(src_page);
 
-         // dst에 익명(anon) 페이지를 초기화 함수와 aux와 함께 할당
-         vm_alloc_page_with_initializer(VM_ANON, upage, writable, init, aux);
+         // dst에 원본과 같은 타입의 페이지를 초기화 함수와 aux와 함께 할당
+         if (!vm_alloc_page_with_initializer(src_page->uninit.type, upage, writable, init, aux))
+         {
+            if (aux != NULL)
+               segment_put(aux);
+            return false;
+         }
+         spt_find_page(dst, upage)->advice = src_page->advice;
          continue;
       }
 
-      /* 2) type이 file-backed이면(파일 기반 페이지) */
-      if (type == VM_FILE)
+      /* 실행 코드 페이지는 복사하지 않습니다. 자식이 폴트하면 캐시된 프레임을 함께 매핑합니다 */
+      if (type == VM_TEXT)
       {
-         // 원본 페이지의 파일 관련 정보 가져오기
-         struct file_page *src_info = &src_page->file;
-         // 파일 핸들을 복사하고 읽을 위치 및 바이트 수 정보를 포함한 lazy_load_info 생성
-         struct lazy_load_info *info = make_info(file_reopen(src_info->file), src_info->offset, src_info->read_byte);
-         // mmap 관련 정보 생성(복사할 때 매핑 카운트 등 포함)
-         struct mmap_info *mmap_info = make_mmap_info(info, src_info->mapping_count);
-         void *aux = mmap_info;
-
-         // 부모 프로세스(src)에서 이미 초기화된 페이지 내용을 명시적으로 복사
-         if (!vm_alloc_page_with_initializer(type, upage, writable, lazy_load_segment, aux))
+         struct segment *seg = segment_get(src_page->file.seg);
+         if (!vm_alloc_page_with_initializer(VM_TEXT, upage, writable, lazy_load_segment, seg))
+         {
+            segment_put(seg);
             return false;
-
-         /* 부모에서 이미 초기화된 페이지이기에 바로 명시적 초기화 호출 */
-         if (!vm_copy_claim_page(upage, src_page, dst))
-            return false;
-
+         }
+         spt_find_page(dst, upage)->advice = src_page->advice;
          continue;
       }
 
-      /* 3) type이 anon이면 */
-      if (!vm_alloc_page_with_initializer(type, upage, writable, NULL, NULL)) // uninit page 생성 & 초기화
-         // init(lazy_load_segment)는 page_fault가 발생할때 호출됨
-         // 지금 만드는 페이지는 page_fault가 일어날 때까지 기다리지 않고 바로 내용을 넣어줘야 하므로 필요 없음
-         return false;
-
-      // vm_claim_page으로 요청해서 매핑 & 페이지 타입에 맞게 초기화
-      // if (!vm_claim_page(upage))
-      // return false;
-      /* Project 3 extra : COW */ 
-      if (!vm_copy_claim_page(upage, src_page, dst))
+      /* 3) 초기화된 익명/파일 페이지: 같은 타입의 페이지를 만들고 내용은 부모와 함께 씁니다 */
+      struct segment *seg = type == VM_ANON ? NULL : segment_get(src_page->file.seg);
+      if (!vm_alloc_page_with_initializer(type, upage, writable,
+                                          seg != NULL ? lazy_load_segment : NULL, seg))
+      {
+         if (seg != NULL)
+            segment_put(seg);
          return false;
-
-      // 매핑된 프레임(실제 메모리)에 src 페이지 내용 복사
+      }
       struct page *dst_page = spt_find_page(dst, upage);
-      memcpy(dst_page->frame->kva, src_page->frame->kva, PGSIZE);
+      dst_page->advice = src_page->advice;
+      if (!vm_cow_share_page(dst_page, src_page))
+         return false;
    }
    return true;
 }
@@ -640,35 +2304,18 @@ void supplemental_page_table_kill(struct supplemental_page_table *spt UNUSED)
 {
    /* TODO: 스레드가 보유한 모든 supplemental_page_table을 제거하고,
     * TODO: 수정된 내용을 스토리지에 기록(writeback)하세요. */
-   struct thread *curr = thread_current();
-   hash_clear(&curr->spt, hash_spt_entry_kill);
-}
-
-static void hash_spt_entry_kill(struct hash_elem *e, void *aux)
-{
-   struct SPT_entry *entry = hash_entry(e, struct SPT_entry, elem);
-   /** spt_remove_page는 내부적으로 vm_delloc_page를 호출하고,
-    * vm_delloc_page는 내부적으로 destroy 매크로를 호출한 다음
-    * free(page)를 진행합니다.
-    * 따라서 페이지의 타입에 따라 다른 destory 함수가 호출될 것으로 기대됩니다.
-    */
-   struct thread *curr = thread_current();
-
-   vm_dealloc_page(entry->page);
-   free(entry);
+   /* 페이지마다 invlpg 하지 않고 끝난 뒤 TLB를 한 번에 비웁니다 */
+   tlb_batch_begin();
+   hash_clear(&spt->SPT_hash_list, hash_spt_page_kill);
+   tlb_batch_end();
+   ASSERT(spt->rss == 0);
+   /* 영역은 페이지를 모두 정리한 뒤 해제합니다.
+    * mmap 페이지의 write-back은 각 페이지의 구간 디스크립터가 가진 파일 핸들을 씁니다 */
+   vma_set_destroy(&spt->vmas);
 }
 
-void frame_table_insert(struct list_elem *elem)
+static void hash_spt_page_kill(struct hash_elem *e, void *aux UNUSED)
 {
-   struct thread *cur = thread_current();
-   list_push_back(&frame_table, elem);
-   return;
+   /* vm_dealloc_page는 타입별 destroy를 호출한 뒤 page를 free 합니다 */
+   vm_dealloc_page(hash_entry(e, struct page, spt_elem));
 }
-
-struct frame *frame_table_remove(void)
-{
-   struct thread *cur = thread_current();
-   if (list_empty(&frame_table))
-      return NULL;
-   return list_entry(list_pop_front(&frame_table), struct frame, elem);
-}
\ No newline at end of file
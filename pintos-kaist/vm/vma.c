@@ -0,0 +1,169 @@
+/* vma.c: 프로세스 주소 공간의 영역(VMA) 관리.
+ *
+ * SPT가 페이지 단위 정보를 담는다면, VMA는 ELF 세그먼트, 스택, mmap처럼
+ * 통째로 다루는 범위를 담습니다. mmap의 겹침 검사, munmap의 범위 결정,
+ * 페이지가 없는 주소에서 난 폴트의 분류를 페이지 수와 무관하게 처리합니다. */
+
+#include "vm/vma.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/malloc.h"
+
+/* 빈 영역 집합으로 초기화합니다. */
+void
+vma_set_init(struct vma_set *set)
+{
+	set->vmas = NULL;
+	set->cnt = 0;
+	set->cap = 0;
+}
+
+/* 모든 영역을 해제합니다.
+ * 이후 SET은 빈 집합으로 다시 쓸 수 있습니다. */
+void
+vma_set_destroy(struct vma_set *set)
+{
+	for (size_t i = 0; i < set->cnt; i++)
+		free(set->vmas[i]);
+	free(set->vmas);
+	vma_set_init(set);
+}
+
+/* 끝 주소가 ADDR보다 큰 첫 영역의 인덱스를 반환합니다. 없으면 set->cnt.
+ * 영역들이 겹치지 않으므로 끝 주소도 시작 주소 순으로 정렬되어 있습니다. */
+static size_t
+vma_lower_bound(const struct vma_set *set, const void *addr)
+{
+	size_t lo = 0, hi = set->cnt;
+
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if (set->vmas[mid]->end <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* ADDR을 포함하는 영역을 반환합니다. 없으면 NULL. */
+struct vma *
+vma_find(const struct vma_set *set, const void *addr)
+{
+	size_t i = vma_lower_bound(set, addr);
+
+	if (i < set->cnt && set->vmas[i]->start <= addr)
+		return set->vmas[i];
+	return NULL;
+}
+
+/* [START, END)와 겹치는 영역이 있으면 true를 반환합니다. */
+bool
+vma_overlaps(const struct vma_set *set, const void *start, const void *end)
+{
+	size_t i = vma_lower_bound(set, start);
+
+	return i < set->cnt && set->vmas[i]->start < end;
+}
+
+/* SET의 I번째 자리에 VMA를 끼워 넣습니다. 메모리가 부족하면 false. */
+static bool
+vma_insert_at(struct vma_set *set, size_t i, struct vma *vma)
+{
+	if (set->cnt == set->cap)
+	{
+		size_t cap = set->cap > 0 ? set->cap * 2 : 8;
+		struct vma **vmas = realloc(set->vmas, cap * sizeof *vmas);
+		if (vmas == NULL)
+			return false;
+		set->vmas = vmas;
+		set->cap = cap;
+	}
+	memmove(&set->vmas[i + 1], &set->vmas[i], (set->cnt - i) * sizeof *set->vmas);
+	set->vmas[i] = vma;
+	set->cnt++;
+	return true;
+}
+
+/* 페이지 정렬된 [START, END) 영역을 새로 등록하고 반환합니다.
+ * 기존 영역과 겹치거나 메모리가 부족하면 NULL을 반환합니다. */
+struct vma *
+vma_insert(struct vma_set *set, void *start, void *end,
+		   enum vma_kind kind, bool writable)
+{
+	ASSERT(start < end);
+
+	size_t i = vma_lower_bound(set, start);
+	if (i < set->cnt && set->vmas[i]->start < end)
+		return NULL;
+
+	struct vma *vma = malloc(sizeof *vma);
+	if (vma == NULL)
+		return NULL;
+	vma->start = start;
+	vma->end = end;
+	vma->kind = kind;
+	vma->writable = writable;
+
+	if (!vma_insert_at(set, i, vma))
+	{
+		free(vma);
+		return NULL;
+	}
+	return vma;
+}
+
+/* VMA를 SET에서 빼고 해제합니다. 영역에 속한 페이지는 호출자가 먼저 정리해야 합니다. */
+void
+vma_remove(struct vma_set *set, struct vma *vma)
+{
+	size_t i = vma_lower_bound(set, vma->start);
+
+	ASSERT(i < set->cnt && set->vmas[i] == vma);
+	memmove(&set->vmas[i], &set->vmas[i + 1], (set->cnt - i - 1) * sizeof *set->vmas);
+	set->cnt--;
+	free(vma);
+}
+
+/* VMA의 끝을 페이지 정렬된 END로 옮깁니다.
+ * 늘렸을 때 다음 영역과 겹치면 아무것도 바꾸지 않고 false를 반환합니다.
+ * 줄일 때 범위 밖으로 나간 페이지는 호출자가 먼저 정리해야 합니다. */
+bool
+vma_resize(struct vma_set *set, struct vma *vma, void *end)
+{
+	size_t i = vma_lower_bound(set, vma->start);
+
+	ASSERT(i < set->cnt && set->vmas[i] == vma);
+	ASSERT(end > vma->start);
+
+	if (end > vma->end && i + 1 < set->cnt && set->vmas[i + 1]->start < end)
+		return false;
+	vma->end = end;
+	return true;
+}
+
+/* 종류가 KIND인 영역들 중 가장 큰 끝 주소를 반환합니다. 없으면 NULL. */
+void *
+vma_kind_end(const struct vma_set *set, enum vma_kind kind)
+{
+	for (size_t i = set->cnt; i > 0; i--)
+		if (set->vmas[i - 1]->kind == kind)
+			return set->vmas[i - 1]->end;
+	return NULL;
+}
+
+/* fork: SRC의 모든 영역을 빈 집합 DST로 복제합니다. */
+bool
+vma_set_copy(struct vma_set *dst, const struct vma_set *src)
+{
+	ASSERT(dst->cnt == 0);
+
+	for (size_t i = 0; i < src->cnt; i++)
+	{
+		const struct vma *s = src->vmas[i];
+		if (vma_insert(dst, s->start, s->end, s->kind, s->writable) == NULL)
+			return false;
+	}
+	return true;
+}
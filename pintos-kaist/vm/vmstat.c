@@ -0,0 +1,118 @@
+/* vmstat.c: VM 폴트와 교체의 종류별 횟수와 지연 시간(TSC 사이클) 통계.
+ *
+ * 폴트는 처리 경로별로, 교체는 페이지 타입별로 나눠 셉니다.
+ * 지연 시간은 2의 거듭제곱 단위 히스토그램으로 모으므로 기록은 비트 연산 하나로 끝나고,
+ * 분위수는 버킷 경계(최대 2배 오차)로 근사합니다.
+ * 통계는 대략적인 값이면 충분하므로 락 없이 갱신합니다.
+ * 종료 시 vm_print_stats가 출력하며, get_vmstat() 시스템 콜로 읽을 수 있습니다. */
+
+#include "vm/vmstat.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+
+static struct vmstat stats;
+
+static const char *fault_names[VMSTAT_FAULT_CNT] = {
+	"stack", "elf", "mmap", "zero", "swap", "cow", "minor", "kernel", "bogus",
+};
+
+static const char *evict_names[VMSTAT_EVICT_CNT] = {
+	"anon", "file", "text",
+};
+
+/* 히스토그램 H에 CYCLES 사이클이 걸린 사건 하나를 더합니다. */
+static void
+hist_add(struct vmstat_hist *h, uint64_t cycles)
+{
+	int bucket = cycles > 1 ? 63 - __builtin_clzll(cycles) : 0;
+
+	h->cnt++;
+	h->cycles += cycles;
+	if (cycles > h->max)
+		h->max = cycles;
+	h->buckets[bucket < VMSTAT_BUCKETS ? bucket : VMSTAT_BUCKETS - 1]++;
+}
+
+/* 히스토그램 H에서 PCT 퍼센트째 사건이 든 버킷의 상한을 반환합니다. */
+static uint64_t
+hist_percentile(const struct vmstat_hist *h, unsigned pct)
+{
+	uint64_t want = (h->cnt * pct + 99) / 100, seen = 0;
+
+	for (int i = 0; i < VMSTAT_BUCKETS; i++)
+	{
+		seen += h->buckets[i];
+		if (seen >= want)
+			return i < VMSTAT_BUCKETS - 1 ? (uint64_t)2 << i : h->max;
+	}
+	return h->max;
+}
+
+/* 히스토그램 H를 NAME 이름의 한 줄로 출력합니다. */
+static void
+hist_print(const char *name, const struct vmstat_hist *h)
+{
+	printf("  %-8s %10llu %10llu %10llu %10llu %10llu\n", name,
+		   (unsigned long long)h->cnt, (unsigned long long)(h->cycles / h->cnt),
+		   (unsigned long long)hist_percentile(h, 50),
+		   (unsigned long long)hist_percentile(h, 99), (unsigned long long)h->max);
+}
+
+/* CLASS 폴트 하나를 처리하는 데 CYCLES 사이클이 걸렸음을 기록합니다. */
+void
+vmstat_fault(enum vmstat_fault class, uint64_t cycles)
+{
+	ASSERT(class < VMSTAT_FAULT_CNT);
+	hist_add(&stats.faults[class], cycles);
+}
+
+/* TYPE 페이지 하나를 교체했음을 기록합니다. */
+void
+vmstat_evict(enum vmstat_evict type)
+{
+	ASSERT(type < VMSTAT_EVICT_CNT);
+	stats.evictions[type].pages++;
+}
+
+/* 교체하면서 TYPE 페이지 PAGES개를 한 번에 기록하는 데 CYCLES 사이클이 걸렸음을 기록합니다. */
+void
+vmstat_writeback(enum vmstat_evict type, size_t pages, uint64_t cycles)
+{
+	ASSERT(type < VMSTAT_EVICT_CNT);
+	stats.evictions[type].written += pages;
+	hist_add(&stats.evictions[type].writeback, cycles);
+}
+
+/* 지금까지의 통계를 ST에 복사합니다. */
+void
+vmstat_get(struct vmstat *st)
+{
+	memcpy(st, &stats, sizeof stats);
+}
+
+/* 한 번이라도 일어난 폴트 종류와 교체된 페이지 타입의 통계를 출력합니다. */
+void
+vmstat_print(void)
+{
+	printf("Fault latency (TSC cycles):\n  %-8s %10s %10s %10s %10s %10s\n",
+		   "class", "count", "avg", "p50", "p99", "max");
+	for (int i = 0; i < VMSTAT_FAULT_CNT; i++)
+		if (stats.faults[i].cnt > 0)
+			hist_print(fault_names[i], &stats.faults[i]);
+
+	for (int i = 0; i < VMSTAT_EVICT_CNT; i++)
+	{
+		const struct vmstat_evict_stat *e = &stats.evictions[i];
+		if (e->pages == 0)
+			continue;
+		printf("Evicted %s: %llu pages, %llu written", evict_names[i],
+			   (unsigned long long)e->pages, (unsigned long long)e->written);
+		if (e->writeback.cnt > 0)
+			printf(" in %llu writes (avg %llu, max %llu cycles)",
+				   (unsigned long long)e->writeback.cnt,
+				   (unsigned long long)(e->writeback.cycles / e->writeback.cnt),
+				   (unsigned long long)e->writeback.max);
+		printf("\n");
+	}
+}
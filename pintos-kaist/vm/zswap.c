@@ -0,0 +1,451 @@
+/* zswap.c: 스왑 디스크 앞단의 압축 메모리 스왑 영역.
+ *
+ * 교체되는 익명 페이지를 LZF 방식으로 압축해 커널 풀의 arena에 보관합니다.
+ * 이후 그 페이지에 다시 폴트가 나면 디스크 I/O 없이 압축만 풀면 됩니다.
+ * - 압축해도 ZSWAP_MAX_LEN보다 큰 페이지는 받지 않고 바로 스왑 디스크로 보냅니다.
+ * - arena가 가득 차면 가장 오래 전에 들어온(cold) 항목부터 스왑 디스크로 내려 보내
+ *   자리를 만듭니다 (writeback).
+ *
+ * arena는 페이지 단위로 크기 클래스(256바이트 배수)에 배정되고, 각 페이지는 같은 크기의
+ * 슬롯들로 나뉩니다. 빈 슬롯과 빈 페이지는 슬롯/페이지 안에 둔 list_elem으로 연결하므로
+ * 별도의 메타데이터 할당이 없습니다. 모든 연산은 zswap_lock으로 직렬화됩니다. */
+
+#include "vm/zswap.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+size_t zswap_pages;
+
+/* arena에 보관된 압축 페이지 하나. 슬롯의 앞부분에 헤더로 놓입니다.
+ * 빈 슬롯일 때는 elem이 크기 클래스별 빈 슬롯 리스트에, 사용 중일 때는 LRU 리스트에 들어갑니다. */
+struct zswap_entry
+{
+	struct list_elem elem;
+	struct page *page; /* 이 항목의 주인 페이지 */
+	uint16_t len;	   /* 압축된 데이터 길이 */
+	uint8_t class;	   /* 슬롯 크기 클래스 */
+	uint8_t data[];	   /* 압축된 데이터 */
+};
+
+#define ZSWAP_CLASS_SIZE 256 /* 크기 클래스 간격 */
+#define ZSWAP_CLASS_CNT 12	 /* 256 .. 3072바이트 */
+#define ZSWAP_MAX_LEN (ZSWAP_CLASS_SIZE * ZSWAP_CLASS_CNT - sizeof(struct zswap_entry))
+/* 한 번 저장할 때 자리를 만들려고 내려 보내는 최대 항목 수 */
+#define ZSWAP_WRITEBACK_MAX 4
+
+/* arena 페이지마다 두는 정보 */
+struct zswap_pageinfo
+{
+	int8_t class;  /* 배정된 크기 클래스, 빈 페이지면 -1 */
+	uint16_t used; /* 사용 중인 슬롯 수 */
+};
+
+static struct lock zswap_lock;
+static uint8_t *arena;
+static struct zswap_pageinfo *page_info;
+static struct list free_pages;					 /* 어느 클래스에도 배정되지 않은 arena 페이지 */
+static struct list class_free[ZSWAP_CLASS_CNT]; /* 클래스별 빈 슬롯 */
+static struct list lru;							 /* 저장된 항목, 오래된 것이 앞 */
+
+/* 압축/해제용 작업 공간 (zswap_lock으로 보호) */
+#define HASH_LOG 12
+static uint16_t hash_table[1 << HASH_LOG];
+static uint8_t comp_buf[ZSWAP_MAX_LEN]; /* 저장할 페이지의 압축 결과 */
+static uint8_t work_buf[PGSIZE];		/* writeback 할 때 압축을 풀어 둘 곳 */
+
+/* 통계 */
+static size_t stored_cnt;			 /* 현재 저장된 페이지 수 */
+static long long store_cnt;			 /* 저장에 성공한 횟수 */
+static long long reject_cnt;		 /* 압축이 안 돼서 디스크로 보낸 횟수 */
+static long long full_cnt;			 /* 자리가 없어 디스크로 보낸 횟수 */
+static long long writeback_cnt;		 /* 오래된 항목을 디스크로 내려 보낸 횟수 */
+static long long hit_cnt;			 /* zswap에서 바로 읽어 들인 횟수 */
+static long long dup_cnt;			 /* fork한 자식 몫으로 항목을 복제한 횟수 */
+static long long compressed_bytes;	 /* 저장된 압축 데이터 누적 크기 */
+
+static size_t lzf_compress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+static bool lzf_decompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+
+/* 크기 클래스 CLASS의 슬롯 크기 */
+static size_t
+class_size(int class)
+{
+	return (class + 1) * ZSWAP_CLASS_SIZE;
+}
+
+/* 항목 E가 들어 있는 arena 페이지 번호 */
+static size_t
+entry_page_idx(struct zswap_entry *e)
+{
+	return ((uint8_t *)e - arena) / PGSIZE;
+}
+
+/* 크기 클래스 CLASS의 빈 슬롯을 하나 꺼냅니다. 자리가 없으면 NULL을 반환합니다. */
+static struct zswap_entry *
+slot_alloc(int class)
+{
+	struct list *list = &class_free[class];
+
+	if (list_empty(list))
+	{
+		if (list_empty(&free_pages))
+			return NULL;
+
+		/* 빈 arena 페이지를 이 클래스에 배정하고 슬롯으로 나눕니다 */
+		uint8_t *kpage = (uint8_t *)list_pop_front(&free_pages);
+		size_t idx = (kpage - arena) / PGSIZE;
+		page_info[idx].class = class;
+		page_info[idx].used = 0;
+		for (size_t ofs = 0; ofs + class_size(class) <= PGSIZE; ofs += class_size(class))
+		{
+			struct zswap_entry *slot = (struct zswap_entry *)(kpage + ofs);
+			slot->class = class;
+			list_push_back(list, &slot->elem);
+		}
+	}
+
+	struct zswap_entry *e = list_entry(list_pop_front(list), struct zswap_entry, elem);
+	page_info[entry_page_idx(e)].used++;
+	return e;
+}
+
+/* 슬롯 E를 돌려줍니다. 그 arena 페이지가 통째로 비면 페이지도 빈 페이지 목록에 돌려줍니다. */
+static void
+slot_free(struct zswap_entry *e)
+{
+	int class = e->class;
+	size_t idx = entry_page_idx(e);
+	uint8_t *kpage = arena + idx * PGSIZE;
+
+	list_push_back(&class_free[class], &e->elem);
+	if (--page_info[idx].used > 0)
+		return;
+
+	for (size_t ofs = 0; ofs + class_size(class) <= PGSIZE; ofs += class_size(class))
+		list_remove(&((struct zswap_entry *)(kpage + ofs))->elem);
+	page_info[idx].class = -1;
+	list_push_back(&free_pages, (struct list_elem *)kpage);
+}
+
+/* 항목 E를 arena에서 지우고 주인 페이지와의 연결을 끊습니다. */
+static void
+entry_remove(struct zswap_entry *e)
+{
+	stored_cnt--;
+	e->page->anon.zswap = NULL;
+	list_remove(&e->elem);
+	slot_free(e);
+}
+
+/* 가장 오래된 항목 하나를 스왑 디스크로 내려 보냅니다. 실패하면 false를 반환합니다. */
+static bool
+zswap_writeback(void)
+{
+	if (list_empty(&lru))
+		return false;
+
+	struct zswap_entry *e = list_entry(list_front(&lru), struct zswap_entry, elem);
+	if (!lzf_decompress(e->data, e->len, work_buf, PGSIZE))
+		PANIC("zswap: corrupted entry");
+	/* 디스크에 기록하고 swap_idx를 정한 뒤에 zswap 항목을 지웁니다 */
+	if (!anon_writeback(e->page, work_buf))
+		return false;
+	entry_remove(e);
+	writeback_cnt++;
+	return true;
+}
+
+/* 압축 스왑 영역을 초기화합니다. zswap_pages가 0이면 아무것도 하지 않습니다. */
+void
+zswap_init(void)
+{
+	lock_init(&zswap_lock);
+	list_init(&free_pages);
+	list_init(&lru);
+	for (int i = 0; i < ZSWAP_CLASS_CNT; i++)
+		list_init(&class_free[i]);
+
+	if (zswap_pages == 0)
+		return;
+
+	arena = palloc_get_multiple(0, zswap_pages);
+	page_info = malloc(zswap_pages * sizeof *page_info);
+	if (arena == NULL || page_info == NULL)
+	{
+		printf("zswap: cannot allocate %zu pages, disabled\n", zswap_pages);
+		if (arena != NULL)
+			palloc_free_multiple(arena, zswap_pages);
+		free(page_info);
+		arena = NULL;
+		zswap_pages = 0;
+		return;
+	}
+
+	for (size_t i = 0; i < zswap_pages; i++)
+	{
+		page_info[i].class = -1;
+		list_push_back(&free_pages, (struct list_elem *)(arena + i * PGSIZE));
+	}
+}
+
+/* KVA에 있는 PAGE의 내용을 압축해 저장합니다.
+ * 압축이 잘 되지 않거나 자리를 만들 수 없으면 false를 반환하며,
+ * 호출자는 이 페이지를 스왑 디스크에 기록해야 합니다. */
+bool
+zswap_store(struct page *page, const void *kva)
+{
+	if (arena == NULL)
+		return false;
+
+	lock_acquire(&zswap_lock);
+	size_t len = lzf_compress(kva, PGSIZE, comp_buf, ZSWAP_MAX_LEN);
+	if (len == 0)
+	{
+		reject_cnt++;
+		lock_release(&zswap_lock);
+		return false;
+	}
+
+	int class = DIV_ROUND_UP(sizeof(struct zswap_entry) + len, ZSWAP_CLASS_SIZE) - 1;
+	struct zswap_entry *e = slot_alloc(class);
+	for (int i = 0; e == NULL && i < ZSWAP_WRITEBACK_MAX && zswap_writeback(); i++)
+		e = slot_alloc(class);
+	if (e == NULL)
+	{
+		full_cnt++;
+		lock_release(&zswap_lock);
+		return false;
+	}
+
+	memcpy(e->data, comp_buf, len);
+	e->page = page;
+	e->len = len;
+	list_push_back(&lru, &e->elem);
+	page->anon.zswap = e;
+
+	stored_cnt++;
+	store_cnt++;
+	compressed_bytes += len;
+	lock_release(&zswap_lock);
+	return true;
+}
+
+/* PAGE가 zswap에 있으면 압축을 풀어 KVA에 채우고 항목을 지운 뒤 true를 반환합니다. */
+bool
+zswap_load(struct page *page, void *kva)
+{
+	lock_acquire(&zswap_lock);
+	struct zswap_entry *e = page->anon.zswap;
+	if (e == NULL)
+	{
+		lock_release(&zswap_lock);
+		return false;
+	}
+
+	if (!lzf_decompress(e->data, e->len, kva, PGSIZE))
+		PANIC("zswap: corrupted entry");
+	entry_remove(e);
+	hit_cnt++;
+	lock_release(&zswap_lock);
+	return true;
+}
+
+/* SRC가 zswap에 있으면 압축된 데이터를 DST 몫으로 한 벌 더 보관하고 true를 반환합니다.
+ * fork한 자식이 압축 해제 없이 스왑된 페이지를 물려받게 하며, 새 항목은 SRC와 같은
+ * 나이로 LRU에 들어갑니다. arena에 자리가 없으면 압축을 풀어 DST 몫의 스왑 슬롯에
+ * 기록하고, 그마저 실패하면 DST는 스왑되지 않은 상태로 남습니다.
+ * SRC가 zswap에 없으면(이미 디스크로 내려갔으면) false를 반환합니다. */
+bool
+zswap_dup(struct page *dst, struct page *src)
+{
+	lock_acquire(&zswap_lock);
+	struct zswap_entry *s = src->anon.zswap;
+	if (s == NULL)
+	{
+		lock_release(&zswap_lock);
+		return false;
+	}
+
+	struct zswap_entry *e = slot_alloc(s->class);
+	if (e != NULL)
+	{
+		memcpy(e->data, s->data, s->len);
+		e->page = dst;
+		e->len = s->len;
+		list_insert(list_next(&s->elem), &e->elem);
+		dst->anon.zswap = e;
+		stored_cnt++;
+		dup_cnt++;
+	}
+	else
+	{
+		if (!lzf_decompress(s->data, s->len, work_buf, PGSIZE))
+			PANIC("zswap: corrupted entry");
+		anon_writeback(dst, work_buf);
+	}
+	lock_release(&zswap_lock);
+	return true;
+}
+
+/* PAGE가 zswap에 있으면 항목을 버립니다. */
+void
+zswap_invalidate(struct page *page)
+{
+	lock_acquire(&zswap_lock);
+	if (page->anon.zswap != NULL)
+		entry_remove(page->anon.zswap);
+	lock_release(&zswap_lock);
+}
+
+/* zswap 통계를 출력합니다. DISK_LOADS는 스왑 디스크에서 읽어 들인 페이지 수로,
+ * 적중률(zswap에서 바로 읽은 비율)을 계산하는 데 씁니다. */
+void
+zswap_print_stats(long long disk_loads)
+{
+	if (arena == NULL)
+		return;
+
+	long long loads = hit_cnt + disk_loads;
+	long long ratio = compressed_bytes > 0 ? store_cnt * PGSIZE * 100 / compressed_bytes : 0;
+	printf("Zswap: %zu pages stored in %zu arena pages, %lld stores, %lld incompressible, "
+		   "%lld full, %lld writebacks, %lld fork copies\n",
+		   stored_cnt, zswap_pages - list_size(&free_pages), store_cnt, reject_cnt,
+		   full_cnt, writeback_cnt, dup_cnt);
+	printf("Zswap: %lld of %lld swap-ins hit (%lld%%), compression ratio %lld.%02lld:1\n",
+		   hit_cnt, loads, loads > 0 ? hit_cnt * 100 / loads : 0, ratio / 100, ratio % 100);
+}
+
+/* LZF 압축.
+ * 출력은 다음 두 종류의 명령이 이어진 형태입니다.
+ *   000LLLLL                      : 이어지는 L + 1개(1..32)의 바이트를 그대로 복사
+ *   LLLOOOOO [LLLLLLLL] OOOOOOOO  : 출력 위치에서 O + 1 바이트 앞의 데이터를 L + 2 바이트 복사
+ *                                   (L이 7이면 다음 바이트를 L에 더함)
+ * 결과가 OUT_LEN보다 길어지면 0을 반환합니다. */
+static size_t
+lzf_compress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len)
+{
+	const uint8_t *ip = in, *in_end = in + in_len;
+	uint8_t *op = out, *out_end = out + out_len;
+	uint8_t *lit_ctrl;
+	size_t lit = 0;
+
+	if (out_len < 2)
+		return 0;
+	lit_ctrl = op++;
+
+	while (ip < in_end)
+	{
+		if (ip + 2 < in_end)
+		{
+			uint32_t v = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+			size_t h = (v * 2654435761u) >> (32 - HASH_LOG);
+			const uint8_t *ref = in + hash_table[h];
+			size_t off = ip - ref - 1;
+
+			/* 해시 테이블은 지우지 않으므로 후보는 항상 내용을 비교해 확인합니다 */
+			hash_table[h] = ip - in;
+			if (ref < ip && off < (1 << 13)
+				&& ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2])
+			{
+				size_t max = in_end - ip < 264 ? in_end - ip : 264;
+				size_t len = 3;
+				while (len < max && ref[len] == ip[len])
+					len++;
+
+				/* 진행 중이던 리터럴 구간을 닫습니다 */
+				if (lit > 0)
+					*lit_ctrl = lit - 1;
+				else
+					op--;
+				if (op + 4 > out_end)
+					return 0;
+
+				len -= 2;
+				if (len < 7)
+					*op++ = (off >> 8) + (len << 5);
+				else
+				{
+					*op++ = (off >> 8) + (7 << 5);
+					*op++ = len - 7;
+				}
+				*op++ = off;
+				ip += len + 2;
+
+				lit = 0;
+				lit_ctrl = op++;
+				continue;
+			}
+		}
+
+		if (op >= out_end)
+			return 0;
+		*op++ = *ip++;
+		if (++lit == 32)
+		{
+			*lit_ctrl = lit - 1;
+			lit = 0;
+			if (op >= out_end)
+				return 0;
+			lit_ctrl = op++;
+		}
+	}
+
+	if (lit > 0)
+		*lit_ctrl = lit - 1;
+	else
+		op--;
+	return op - out;
+}
+
+/* lzf_compress()로 압축된 IN을 풀어 OUT을 정확히 OUT_LEN 바이트 채우면 true를 반환합니다. */
+static bool
+lzf_decompress(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len)
+{
+	const uint8_t *ip = in, *in_end = in + in_len;
+	uint8_t *op = out, *out_end = out + out_len;
+
+	while (ip < in_end)
+	{
+		unsigned ctrl = *ip++;
+
+		if (ctrl < 32)
+		{
+			size_t len = ctrl + 1;
+			if (op + len > out_end || ip + len > in_end)
+				return false;
+			memcpy(op, ip, len);
+			op += len;
+			ip += len;
+		}
+		else
+		{
+			size_t len = ctrl >> 5;
+			if (len == 7)
+			{
+				if (ip >= in_end)
+					return false;
+				len += *ip++;
+			}
+			if (ip >= in_end)
+				return false;
+
+			const uint8_t *ref = op - ((ctrl & 0x1f) << 8) - *ip++ - 1;
+			len += 2;
+			if (ref < out || op + len > out_end)
+				return false;
+			/* 원본과 겹칠 수 있으므로 한 바이트씩 복사합니다 */
+			while (len-- > 0)
+				*op++ = *ref++;
+		}
+	}
+	return op == out_end;
+}